@@ -0,0 +1,226 @@
+/**************************************************************[bench_watch.c]
+
+  The MIT License
+
+  Copyright (c) 2022 Guangchen Li
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+
+*******************************************************************************/
+
+/* Time the heap of the VSIDS heuristic (the binary rm_heap, or the
+ * d-ary one when built with DARY_HEAP) on a workload shaped like a
+ * solver: decisions pop variables until one is unassigned, each decision
+ * assigns a few more variables, each conflict bumps variables of the
+ * trail and jumps back, pushing the unassigned variables back.
+ * Then compare building a heap of all variables by pushes and by
+ * rm_heap_build, clearing it by reallocation and in place, and bumping
+ * a share of the variables one by one and as a batch.
+ * Usage: bench_heap [VARS] [CONFLICTS]
+ * Without arguments, formulas of 10^4, 10^5 and 10^6 variables are
+ * simulated.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "rm_heap.h"
+
+// Decisions per conflict, implied variables per decision, and
+// variables bumped per conflict
+#define DECISIONS 8
+#define IMPLIED 16
+#define BUMPED 40
+
+static double now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+#ifdef DARY_HEAP
+#define STR(x) #x
+#define ARITY_NAME(x) STR(x) "-ary "
+static const char *name = ARITY_NAME(RM_HEAP_ARITY);
+#else
+static const char *name = "binary";
+#endif
+
+// The same random sequence for both heaps
+static uint64_t state = 88172645463325252ULL;
+static int pick(int n) {
+  state ^= state << 13;
+  state ^= state >> 7;
+  state ^= state << 17;
+  return (int)(state % (uint64_t)n);
+}
+
+static void run(int n, int conflicts) {
+  rm_heap_t H;
+  rm_heap_init_heap(&H, n + 1);
+  float *activity = calloc(n + 1, sizeof(float)), increment = 1;
+  int *trail = malloc(sizeof(int) * n), assigned = 0;
+  char *isAssigned = calloc(n + 1, 1);
+  if (H.indices == NULL || !activity || !trail || !isAssigned) {
+    printf("out of memory\n");
+    exit(1);
+  }
+  long long pops = 0, pushes = 0, bumps = 0;
+  double start = now();
+  for (int var = 1; var <= n; var++, pushes++)
+    rm_heap_push(&H, var, 0);
+  for (int c = 0; c < conflicts; c++) {
+    for (int d = 0; d < DECISIONS && H.size; d++) {
+      int var;
+      do {
+        rm_heap_pop(&H, &var);
+        pops++;
+      } while (isAssigned[var] && H.size);
+      if (isAssigned[var])
+        break;
+      isAssigned[var] = 1;
+      trail[assigned++] = var;
+      for (int i = 0; i < IMPLIED && assigned < n; i++) {
+        var = 1 + pick(n);
+        if (!isAssigned[var]) {
+          isAssigned[var] = 1;
+          trail[assigned++] = var;
+        }
+      }
+    }
+    // Bump variables, mostly of the top of the trail
+    for (int i = 0; i < BUMPED && assigned; i++, bumps++) {
+      int var = trail[assigned - 1 - pick(1 + pick(assigned))];
+      if ((activity[var] += increment) > 1e20f) {
+        for (int v = 1; v <= n; v++)
+          activity[v] *= 1e-20f;
+        rm_heap_scale(&H, 1e-20f);
+        increment *= 1e-20f;
+      }
+      if (rm_heap_in_heap(&H, var))
+        rm_heap_increase(&H, var, activity[var]);
+    }
+    increment *= 1 / 0.95f;
+    // Jump back over a random part of the trail
+    for (int keep = pick(assigned + 1); assigned > keep;) {
+      int var = trail[--assigned];
+      isAssigned[var] = 0;
+      // Implied variables were not popped
+      if (!rm_heap_in_heap(&H, var)) {
+        rm_heap_push(&H, var, activity[var]);
+        pushes++;
+      }
+    }
+  }
+  double elapsed = now() - start;
+  long long ops = pops + pushes + bumps;
+  printf("%s %8d vars %7d conflicts %10lld ops %8.3f s %7.2f Mops/s\n", name, n,
+         conflicts, ops, elapsed, ops / elapsed * 1e-6);
+  rm_heap_destroy_heap(&H);
+  free(activity);
+  free(trail);
+  free(isAssigned);
+}
+
+// Time the bulk operations on n variables, rounds times each
+static void runBulk(int n, int rounds) {
+  rm_heap_t H;
+  rm_heap_init_heap(&H, n + 1);
+  float *activity = malloc(sizeof(float) * (n + 1));
+  int *vars = malloc(sizeof(int) * n);
+  if (H.indices == NULL || !activity || !vars) {
+    printf("out of memory\n");
+    exit(1);
+  }
+  for (int var = 1; var <= n; var++) {
+    activity[var] = pick(1000000) / 1000.0f;
+    vars[var - 1] = var;
+  }
+  double t[8] = {0};
+  for (int r = 0; r < rounds; r++) {
+    double start = now();
+    for (int i = 0; i < n; i++)
+      rm_heap_push(&H, vars[i], activity[vars[i]]);
+    t[0] += now() - start;
+    start = now();
+    rm_heap_destroy_heap(&H);
+    rm_heap_init_heap(&H, n + 1);
+    t[2] += now() - start;
+    start = now();
+    rm_heap_build(&H, vars, n, activity);
+    t[1] += now() - start;
+    start = now();
+    rm_heap_clear(&H);
+    t[3] += now() - start;
+    // Bump 1% and 30% of the variables, as VSIDS does with a growing
+    // increment, each bump makes a variable the most active one
+    for (int k = 0; k < 2; k++) {
+      int bumps = k ? n / 10 * 3 : n / 100;
+      float top = 1000;
+      for (int var = 1; var <= n; var++)
+        activity[var] = pick(1000000) / 1000.0f;
+      rm_heap_build(&H, vars, n, activity);
+      start = now();
+      for (int i = 0; i < bumps; i++) {
+        int var = 1 + pick(n);
+        rm_heap_update(&H, var, activity[var] = ++top);
+      }
+      t[4 + 2 * k] += now() - start;
+      for (int var = 1; var <= n; var++)
+        activity[var] = pick(1000000) / 1000.0f;
+      rm_heap_build(&H, vars, n, activity);
+      start = now();
+      for (int i = 0; i < bumps; i++) {
+        int var = 1 + pick(n);
+        rm_heap_batch_set(&H, var, activity[var] = ++top);
+      }
+      rm_heap_batch_end(&H);
+      t[5 + 2 * k] += now() - start;
+    }
+    rm_heap_clear(&H);
+  }
+  printf("%s %8d vars: build %8.3f ms (pushes %8.3f ms), clear %6.3f ms "
+         "(realloc %6.3f ms)\n",
+         name, n, t[1] / rounds * 1e3, t[0] / rounds * 1e3,
+         t[3] / rounds * 1e3, t[2] / rounds * 1e3);
+  printf("%s %8d vars: bump 1%% batch %6.3f ms (updates %6.3f ms), "
+         "bump 30%% batch %6.3f ms (updates %6.3f ms)\n",
+         name, n, t[5] / rounds * 1e3, t[4] / rounds * 1e3,
+         t[7] / rounds * 1e3, t[6] / rounds * 1e3);
+  rm_heap_destroy_heap(&H);
+  free(activity);
+  free(vars);
+}
+
+int main(int argc, char **argv) {
+  if (argc > 1) {
+    run(atoi(argv[1]), argc > 2 ? atoi(argv[2]) : 100000);
+    runBulk(atoi(argv[1]), 10);
+    return 0;
+  }
+  for (int n = 10000; n <= 1000000; n *= 10)
+    run(n, 100000);
+  for (int n = 10000; n <= 1000000; n *= 10)
+    runBulk(n, 10);
+  return 0;
+}
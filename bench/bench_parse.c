@@ -0,0 +1,101 @@
+/**************************************************************[bench_parse.c]
+
+  The MIT License
+
+  Copyright (c) 2022 Guangchen Li
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+
+*******************************************************************************/
+
+/* Compare the parse throughput of the DIMACS front ends, including
+ * the threaded loader with 2, 4, ... threads and the binary format.
+ * Usage: bench_parse FILE [REPEAT]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "dimacs.h"
+#include "microsat.h"
+
+static double now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Run a parser REPEAT times and report the best throughput
+static void run(const char *name, int (*parser)(solver_t *, char *),
+                int threads, char *file, double mb, int repeat) {
+  double best = -1;
+  long long mem_used = 0;
+  for (int i = 0; i < repeat; i++) {
+    solver_t S;
+    defaultOptions(&S.opt);
+    S.opt.threads = threads;
+    double start = now();
+    parser(&S, file);
+    double elapsed = now() - start;
+    mem_used = S.mem_used;
+    freeCDCL(&S);
+    if (best < 0 || elapsed < best)
+      best = elapsed;
+  }
+  printf("%-8s %10.3f s %10.1f MB/s   mem: %lld\n", name, best, mb / best,
+         mem_used);
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    printf("usage: %s FILE [REPEAT]\n", argv[0]);
+    return 1;
+  }
+  int repeat = argc > 2 ? atoi(argv[2]) : 3;
+  struct stat st;
+  if (stat(argv[1], &st)) {
+    printf("cannot stat %s\n", argv[1]);
+    return 1;
+  }
+  double mb = st.st_size / (1024.0 * 1024.0);
+  printf("%s: %.1f MB, best of %i\n", argv[1], mb, repeat);
+  run("fscanf", parseStdio, 1, argv[1], mb, repeat);
+  run("mmap", parse, 1, argv[1], mb, repeat);
+  // Powers of two up to the number of cores
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);
+  for (int threads = 2; threads <= cores || threads == 2; threads *= 2) {
+    char name[32];
+    sprintf(name, "mmap/%i", threads);
+    run(name, parse, threads, argv[1], mb, repeat);
+  }
+  // Throughput of the binary format is relative to the text size
+  char binary[] = "/tmp/bench_parse_XXXXXX";
+  int fd = mkstemp(binary);
+  if (fd >= 0 && !convert(argv[1], binary))
+    run("binary", parse, 1, binary, mb, repeat);
+  if (fd >= 0) {
+    close(fd);
+    unlink(binary);
+  }
+}
@@ -0,0 +1,286 @@
+/**************************************************************[bench_watch.c]
+
+  The MIT License
+
+  Copyright (c) 2022 Guangchen Li
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+
+*******************************************************************************/
+
+/* Compare the propagation throughput of watch layouts on the clauses of
+ * a formula: the linked lists threaded through the clause database that
+ * microsat used originally, per-literal watch vectors with blocker
+ * literals, and watch vectors with implicit binary clauses as used now.
+ * All propagate the same random decisions, without learning, until a
+ * conflict or a full assignment. Without ROUNDS, the first layout runs
+ * rounds for a second, and the others run as many.
+ * Usage: bench_watch FILE [ROUNDS]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "microsat.h"
+
+#define END -9
+
+typedef struct {
+  int nVars, *isFalse, *trail, assigned, processed;
+  long long props;
+} bench_t;
+
+static double now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void setTrue(bench_t *B, int lit) {
+  B->isFalse[-lit] = 1;
+  B->trail[B->assigned++] = -lit;
+}
+
+static void reset(bench_t *B) {
+  while (B->assigned)
+    B->isFalse[B->trail[--B->assigned]] = 0;
+  B->processed = 0;
+}
+
+// The clauses as [link0, link1, lits..., 0], first[lit] is the offset
+// of the link of the first clause watching lit
+static int propagateLinked(bench_t *B, int *DB, int *first) {
+  while (B->processed < B->assigned) {
+    int lit = B->trail[B->processed++];
+    B->props++;
+    int *watch = &first[lit];
+    while (*watch != END) {
+      int i, unit = 1;
+      int *clause = DB + *watch + 1;
+      if (clause[-2] == 0)
+        clause++;
+      if (clause[0] == lit)
+        clause[0] = clause[1];
+      for (i = 2; unit && clause[i]; i++)
+        if (!B->isFalse[clause[i]]) {
+          clause[1] = clause[i];
+          clause[i] = lit;
+          int store = *watch;
+          unit = 0;
+          *watch = DB[*watch];
+          DB[store] = first[clause[1]];
+          first[clause[1]] = store;
+        }
+      if (unit) {
+        clause[1] = lit;
+        watch = DB + *watch;
+        if (B->isFalse[-clause[0]])
+          continue;
+        if (B->isFalse[clause[0]])
+          return 0;
+        setTrue(B, clause[0]);
+      }
+    }
+  }
+  return 1;
+}
+
+static void addWatch(watches_t *ws, ref_t clause, int blocker) {
+  if (ws->size == ws->capacity) {
+    ws->capacity = ws->capacity ? 2 * ws->capacity : 4;
+    ws->list = realloc(ws->list, sizeof(watch_t) * ws->capacity);
+    if (ws->list == NULL) {
+      printf("out of memory\n");
+      exit(1);
+    }
+  }
+  ws->list[ws->size++] = (watch_t){clause, blocker};
+}
+
+// The clauses as [lits..., 0], as in propagate in microsat.c
+// Binary clauses with a negative offset are not read
+static int propagateVectors(bench_t *B, int *DB, watches_t *watches) {
+  while (B->processed < B->assigned) {
+    int lit = B->trail[B->processed++];
+    B->props++;
+    watches_t *ws = &watches[lit];
+    watch_t *i = ws->list, *j = ws->list, *end = ws->list + ws->size;
+    int conflict = 0;
+    while (i < end) {
+      watch_t w = *(i++);
+      if (B->isFalse[-w.blocker]) {
+        *(j++) = w;
+        continue;
+      }
+      if (w.clause < 0) {
+        *(j++) = w;
+        if (!B->isFalse[w.blocker]) {
+          setTrue(B, w.blocker);
+          continue;
+        }
+        conflict = 1;
+        while (i < end)
+          *(j++) = *(i++);
+        break;
+      }
+      int *clause = DB + w.clause;
+      if (clause[0] == lit)
+        clause[0] = clause[1];
+      clause[1] = lit;
+      w.blocker = clause[0];
+      if (B->isFalse[-clause[0]]) {
+        *(j++) = w;
+        continue;
+      }
+      int k;
+      for (k = 2; clause[k] && B->isFalse[clause[k]]; k++)
+        ;
+      if (clause[k]) {
+        clause[1] = clause[k];
+        clause[k] = lit;
+        addWatch(&watches[clause[1]], w.clause, clause[0]);
+        continue;
+      }
+      *(j++) = w;
+      if (!B->isFalse[clause[0]]) {
+        setTrue(B, clause[0]);
+        continue;
+      }
+      conflict = 1;
+      while (i < end)
+        *(j++) = *(i++);
+    }
+    ws->size = (int)(j - ws->list);
+    if (conflict)
+      return 0;
+  }
+  return 1;
+}
+
+// Propagate rounds of random decisions (for a second if *rounds is 0),
+// return the propagation time
+static double run(bench_t *B, int *rounds, int *DB, int *first,
+                  watches_t *watches) {
+  double elapsed = 0;
+  srand(1);
+  for (int r = 0; *rounds ? r < *rounds : elapsed < 1; r++) {
+    reset(B);
+    double start = now();
+    for (;;) {
+      // The same sequence of random decisions for both layouts
+      int var = 1 + rand() % B->nVars, lit = rand() % 2 ? var : -var;
+      if (B->isFalse[lit] || B->isFalse[-lit])
+        continue;
+      setTrue(B, lit);
+      int ok = first ? propagateLinked(B, DB, first)
+                     : propagateVectors(B, DB, watches);
+      if (!ok || B->assigned == B->nVars)
+        break;
+    }
+    elapsed += now() - start;
+    if (!*rounds && elapsed >= 1)
+      *rounds = r + 1;
+  }
+  return elapsed;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    printf("usage: %s FILE [ROUNDS]\n", argv[0]);
+    return 1;
+  }
+  int rounds = argc > 2 ? atoi(argv[2]) : 0;
+  solver_t S;
+  defaultOptions(&S.opt);
+  if (parse(&S, argv[1]) == MEMOUT) {
+    printf("out of memory\n");
+    return 1;
+  }
+  int n = S.nVars, nClauses = 0;
+  ref_t size = 1;
+  // Count the clauses with at least two literals
+  for (ref_t i = 1; i < S.mem_fixed; i++) {
+    ref_t begin = i;
+    while (S.DB[i])
+      i++;
+    if (i - begin > 1) {
+      nClauses++;
+      size += i - begin + 1;
+    }
+  }
+  int *linked = malloc(sizeof(int) * (size + 2 * nClauses));
+  // Propagation reorders the literals, so each layout has its own copy
+  int *flat = malloc(sizeof(int) * size);
+  int *flat2 = malloc(sizeof(int) * size);
+  int *first = malloc(sizeof(int) * (2 * n + 1));
+  watches_t *watches = calloc(2 * n + 1, sizeof(watches_t));
+  watches_t *binaries = calloc(2 * n + 1, sizeof(watches_t));
+  bench_t B = {n, calloc(2 * n + 1, sizeof(int)), malloc(sizeof(int) * n)};
+  if (!linked || !flat || !flat2 || !first || !watches || !binaries ||
+      !B.isFalse || !B.trail) {
+    printf("out of memory\n");
+    return 1;
+  }
+  first += n;
+  watches += n;
+  binaries += n;
+  B.isFalse += n;
+  for (int lit = -n; lit <= n; lit++)
+    first[lit] = END;
+  // Copy the clauses into both layouts
+  ref_t l = 0, f = 0;
+  linked[l++] = flat[f++] = 0;
+  for (ref_t i = 1; i < S.mem_fixed; i++) {
+    int *clause = S.DB + i;
+    while (S.DB[i])
+      i++;
+    if (S.DB + i - clause < 2)
+      continue;
+    linked[l] = first[clause[0]];
+    first[clause[0]] = (int)l;
+    linked[l + 1] = first[clause[1]];
+    first[clause[1]] = (int)l + 1;
+    addWatch(&watches[clause[0]], f, clause[1]);
+    addWatch(&watches[clause[1]], f, clause[0]);
+    ref_t binary = S.DB + i - clause == 2 ? -f : f;
+    addWatch(&binaries[clause[0]], binary, clause[1]);
+    addWatch(&binaries[clause[1]], binary, clause[0]);
+    for (l += 2; *clause; clause++)
+      linked[l++] = flat[f++] = *clause;
+    linked[l++] = flat[f++] = 0;
+  }
+  freeCDCL(&S);
+  printf("%s: %i variables, %i clauses\n", argv[1], n, nClauses);
+  memcpy(flat2, flat, sizeof(int) * size);
+  const char *names[] = {"linked", "vectors", "binaries"};
+  int *DBs[] = {linked, flat, flat2};
+  watches_t *layouts[] = {NULL, watches, binaries};
+  for (int layout = 0; layout < 3; layout++) {
+    B.props = 0;
+    double elapsed = run(&B, &rounds, DBs[layout], layout ? NULL : first,
+                         layouts[layout]);
+    printf("%-8s %6i rounds %12lld props %8.3f s %8.2f Mprops/s\n",
+           names[layout], rounds, B.props, elapsed, B.props / elapsed * 1e-6);
+  }
+  return 0;
+}
@@ -0,0 +1,48 @@
+#!/bin/sh
+# Compare the conflicts per second of the solver at git revision REV
+# (default HEAD) with the one of the working tree
+# usage: bench/conflicts.sh FILE... (REV=rev, CONFLICTS=n stops each run
+# after n conflicts, REPEAT=n sets the runs per formula)
+
+REV=${REV:-HEAD}
+CONFLICTS=${CONFLICTS:-100000}
+REPEAT=${REPEAT:-3}
+cd "$(dirname "$0")/.." || exit 1
+
+rm -rf build/rev
+mkdir -p build/rev
+git archive "$REV" | tar -x -C build/rev || exit 1
+make -s -C build/rev >/dev/null || exit 1
+make -s BUILD=build/tree >/dev/null || exit 1
+
+# Conflicts and best wall time in milliseconds of REPEAT runs of solver $1
+# on file $2
+best() {
+  best=
+  i=0
+  while [ $i -lt "$REPEAT" ]; do
+    start=$(date +%s%N)
+    conflicts=$("$1" --conflicts="$CONFLICTS" "$2" |
+      sed -n 's/^c mem: .* conflicts: \([0-9]*\).*/\1/p')
+    ms=$((($(date +%s%N) - start) / 1000000))
+    if [ -z "$best" ] || [ $ms -lt $best ]; then
+      best=$ms
+    fi
+    i=$((i + 1))
+  done
+  echo "${conflicts:-0} $best"
+}
+
+# Conflicts per second of $1 conflicts in $2 milliseconds
+rate() { awk "BEGIN { printf \"%.0f\", $2 ? $1 * 1000 / $2 : 0 }"; }
+
+printf "%-30s %10s %10s %10s %10s %6s\n" file conflicts "$REV/s" \
+  conflicts "tree/s" ratio
+for file in "$@"; do
+  set -- $(best build/rev/build/microsat+ "$file")
+  c1=$1 r1=$(rate $1 $2)
+  set -- $(best build/tree/microsat+ "$file")
+  c2=$1 r2=$(rate $1 $2)
+  printf "%-30s %10d %10d %10d %10d %6s\n" "$(basename "$file")" $c1 $r1 \
+    $c2 $r2 "$(awk "BEGIN { if ($r1) printf \"%.2f\", $r2 / $r1 }")"
+done
@@ -0,0 +1,40 @@
+#!/bin/sh
+# Compare the solver built with 32-bit and with 64-bit clause offsets
+# usage: bench/offsets.sh FILE... (REPEAT=n sets the runs per formula)
+
+REPEAT=${REPEAT:-3}
+cd "$(dirname "$0")/.." || exit 1
+
+for bits in 32 64; do
+  make -s BUILD=build/offsets$bits OFFSETS=$bits >/dev/null || exit 1
+done
+
+# Best wall time in milliseconds of REPEAT runs of solver $1 on file $2
+best() {
+  best=
+  i=0
+  while [ $i -lt "$REPEAT" ]; do
+    start=$(date +%s%N)
+    "$1" "$2" >/dev/null
+    ms=$((($(date +%s%N) - start) / 1000000))
+    if [ -z "$best" ] || [ $ms -lt $best ]; then
+      best=$ms
+    fi
+    i=$((i + 1))
+  done
+  echo $best
+}
+
+printf "%-40s %10s %10s %8s\n" file "32-bit ms" "64-bit ms" ratio
+total32=0
+total64=0
+for file in "$@"; do
+  t32=$(best build/offsets32/microsat+ "$file")
+  t64=$(best build/offsets64/microsat+ "$file")
+  total32=$((total32 + t32))
+  total64=$((total64 + t64))
+  printf "%-40s %10d %10d %8s\n" "$(basename "$file")" $t32 $t64 \
+    "$(awk "BEGIN { if ($t32) printf \"%.2f\", $t64 / $t32 }")"
+done
+printf "%-40s %10d %10d %8s\n" total $total32 $total64 \
+  "$(awk "BEGIN { if ($total32) printf \"%.2f\", $total64 / $total32 }")"
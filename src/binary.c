@@ -0,0 +1,209 @@
+/**************************************************************[binary.c]*****
+
+  The MIT License
+
+  Copyright (c) 2022 Guangchen Li
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+
+*******************************************************************************/
+
+#include "binary.h"
+#include "dimacs.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAGIC "MSATCNF\1"
+#define HEADER_SIZE 40
+// Size of the output buffer of a writer
+#define OUT_SIZE (1 << 20)
+
+struct writer {
+  FILE *file;
+  unsigned char *buffer;
+  size_t used;
+  uint64_t nClauses, nLiterals;
+};
+
+static void corrupt() {
+  printf("parse error: corrupt binary CNF\n");
+  exit(1);
+}
+
+static uint64_t get64(const char *p) {
+  uint64_t x = 0;
+  for (int i = 7; i >= 0; i--)
+    x = (x << 8) | (unsigned char)p[i];
+  return x;
+}
+
+static void put64(unsigned char *p, uint64_t x) {
+  for (int i = 0; i < 8; i++, x >>= 8)
+    p[i] = (unsigned char)x;
+}
+
+int isBinary(const char *data, size_t size) {
+  return size >= HEADER_SIZE && !memcmp(data, MAGIC, 8);
+}
+
+uint64_t binaryHash(const char *data) { return get64(data + 8); }
+
+static inline uint64_t rotl(uint64_t x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+// Four independent lanes of 8 bytes keep the multipliers busy
+uint64_t hashBytes(const char *data, size_t size) {
+  const uint64_t P1 = 0x9E3779B185EBCA87ULL, P2 = 0xC2B2AE3D27D4EB4FULL;
+  uint64_t h[4] = {P1, P2, ~P1, ~P2};
+  size_t i = 0;
+  for (; i + 32 <= size; i += 32)
+    for (int j = 0; j < 4; j++) {
+      uint64_t word;
+      memcpy(&word, data + i + 8 * j, 8);
+      h[j] = rotl(h[j] + word * P2, 31) * P1;
+    }
+  uint64_t x = size ^ rotl(h[0], 1) ^ rotl(h[1], 7) ^ rotl(h[2], 12) ^
+               rotl(h[3], 18);
+  for (; i < size; i++)
+    x = (x ^ (unsigned char)data[i]) * P1;
+  x ^= x >> 33;
+  x *= P2;
+  x ^= x >> 29;
+  return x;
+}
+
+static inline uint64_t readVarint(const unsigned char **p,
+                                  const unsigned char *end) {
+  uint64_t x = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    if (*p == end)
+      corrupt();
+    unsigned char byte = *((*p)++);
+    x |= (uint64_t)(byte & 0x7f) << shift;
+    if (!(byte & 0x80))
+      return x;
+  }
+  corrupt();
+  return 0;
+}
+
+int loadBinary(solver_t *S, const char *data, size_t size) {
+  uint64_t nVars = get64(data + 16), nClauses = get64(data + 24);
+  uint64_t nLiterals = get64(data + 32);
+  if (nVars > INT_MAX || nClauses > INT_MAX || nLiterals > LLONG_MAX / 2)
+    corrupt();
+  // Allocate the main datastructures, with exactly the memory
+  // needed by the clauses
+  int res = initCDCL(S, (int)nVars, (int)nClauses,
+                     (long long)(nLiterals + nClauses));
+  if (res != SAT)
+    return res;
+  const unsigned char *p = (const unsigned char *)data + HEADER_SIZE;
+  const unsigned char *end = (const unsigned char *)data + size;
+  for (uint64_t i = 0; i < nClauses; i++) {
+    uint64_t length = readVarint(&p, end), code = 0;
+    if (length > (uint64_t)S->nVars)
+      corrupt();
+    for (int j = 0; j < (int)length; j++) {
+      uint64_t delta = readVarint(&p, end);
+      // Undo the zigzag encoding
+      code += (delta >> 1) ^ -(delta & 1);
+      uint64_t var = code >> 1;
+      if (var < 1 || var > (uint64_t)S->nVars)
+        corrupt();
+      S->buffer[j] = code & 1 ? -(int)var : (int)var;
+    }
+    res = loadClause(S, (int)length);
+    if (res != SAT)
+      return res;
+  }
+  return SAT;
+}
+
+static void flush(writer_t *W) {
+  fwrite(W->buffer, 1, W->used, W->file);
+  W->used = 0;
+}
+
+static inline void writeVarint(writer_t *W, uint64_t x) {
+  while (x >= 0x80) {
+    W->buffer[W->used++] = (unsigned char)(x | 0x80);
+    x >>= 7;
+  }
+  W->buffer[W->used++] = (unsigned char)x;
+}
+
+writer_t *openWriter(const char *path) {
+  writer_t *W = calloc(1, sizeof(writer_t));
+  if (W == NULL)
+    return NULL;
+  W->buffer = malloc(OUT_SIZE);
+  W->file = fopen(path, "wb");
+  if (W->buffer == NULL || W->file == NULL) {
+    if (W->file)
+      fclose(W->file);
+    free(W->buffer);
+    free(W);
+    return NULL;
+  }
+  // The header is completed by closeWriter
+  memset(W->buffer, 0, HEADER_SIZE);
+  W->used = HEADER_SIZE;
+  return W;
+}
+
+void writeClause(writer_t *W, const int *lits, int size) {
+  // A varint of a 64-bit number takes at most 10 bytes
+  if (W->used + 10 * ((size_t)size + 1) > OUT_SIZE)
+    flush(W);
+  writeVarint(W, size);
+  uint64_t prev = 0;
+  for (int i = 0; i < size; i++) {
+    uint64_t code = 2 * (uint64_t)abs(lits[i]) + (lits[i] < 0);
+    int64_t delta = (int64_t)(code - prev);
+    // Zigzag: small negative and positive deltas get short codes
+    writeVarint(W, ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63));
+    prev = code;
+    // Very long clauses are written in pieces
+    if (W->used + 10 > OUT_SIZE)
+      flush(W);
+  }
+  W->nClauses++;
+  W->nLiterals += size;
+}
+
+int closeWriter(writer_t *W, int nVars, uint64_t hash) {
+  flush(W);
+  unsigned char header[HEADER_SIZE];
+  memcpy(header, MAGIC, 8);
+  put64(header + 8, hash);
+  put64(header + 16, nVars);
+  put64(header + 24, W->nClauses);
+  put64(header + 32, W->nLiterals);
+  int res = fseek(W->file, 0, SEEK_SET) ||
+            fwrite(header, 1, HEADER_SIZE, W->file) != HEADER_SIZE;
+  res |= ferror(W->file);
+  res |= fclose(W->file);
+  free(W->buffer);
+  free(W);
+  return res ? -1 : 0;
+}
@@ -0,0 +1,68 @@
+/**************************************************************[binary.h]*****
+
+  The MIT License
+
+  Copyright (c) 2022 Guangchen Li
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+
+*******************************************************************************/
+
+/* A compact binary CNF format. A 40 byte header
+ *
+ *   "MSATCNF\1", hash of the source file, nVars, nClauses, nLiterals
+ *
+ * (64-bit little endian numbers) is followed by the clauses. Each clause
+ * is its size followed by its literals, where literal lit is coded as
+ * 2 * |lit| + (lit < 0) and stored as the zigzag encoded difference to
+ * the code of the previous literal of the clause. All numbers in the
+ * clauses are LEB128 varints.
+ */
+
+#ifndef BINARY
+#define BINARY
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "microsat.h"
+
+// Determine whether data starts with a binary CNF header
+int isBinary(const char *data, size_t size);
+
+// The hash of the source file stored in the header
+uint64_t binaryHash(const char *data);
+
+// Hash size bytes of data
+uint64_t hashBytes(const char *data, size_t size);
+
+// Load a binary CNF of size bytes and initialize
+int loadBinary(solver_t *, const char *data, size_t size);
+
+typedef struct writer writer_t;
+
+// Start a binary CNF at path, return NULL if it cannot be created
+writer_t *openWriter(const char *path);
+
+void writeClause(writer_t *, const int *lits, int size);
+
+// Complete the header and close the file, return 0 on success
+int closeWriter(writer_t *, int nVars, uint64_t hash);
+
+#endif
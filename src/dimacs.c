@@ -0,0 +1,735 @@
+/**************************************************************[dimacs.c]*****
+
+  The MIT License
+
+  Copyright (c) 2022 Guangchen Li
+  Copyright (c) 2014-2018 Marijn Heule
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+
+*******************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "dimacs.h"
+#include "binary.h"
+#include "stream.h"
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// A window [pos, end) of the input. When it is exhausted, refill
+// replaces it with the next window (the next block of stream, if any)
+// and returns 0 at the end of input.
+// Parse errors exit, unless onError is set: then the error message is
+// stored and the parser jumps back to onError.
+typedef struct reader {
+  const char *pos, *end;
+  int (*refill)(struct reader *);
+  stream_t *stream;
+  jmp_buf *onError;
+  const char *error;
+} reader_t;
+
+// A mapped file is a single window
+static int noRefill(reader_t *R) { return 0; }
+
+static int streamRefill(reader_t *R) {
+  return nextBlock(R->stream, &R->pos, &R->end);
+}
+
+static inline int readChar(reader_t *R) {
+  if (R->pos == R->end && !R->refill(R))
+    return EOF;
+  return (unsigned char)*(R->pos++);
+}
+
+static inline int isSpace(int ch) {
+  return ch == ' ' || (ch >= '\t' && ch <= '\r');
+}
+
+static void fail(const char *msg) {
+  printf("parse error: %s\n", msg);
+  exit(1);
+}
+
+static void parseError(reader_t *R, const char *msg) {
+  if (R->onError) {
+    R->error = msg;
+    longjmp(*R->onError, 1);
+  }
+  fail(msg);
+}
+
+// Skip the remainder of a comment line
+static void skipLine(reader_t *R) {
+  int ch;
+  while ((ch = readChar(R)) != '\n' && ch != EOF)
+    ;
+}
+
+// Return the first character of the next token; comment lines
+// are skipped just as white space
+static int nextToken(reader_t *R) {
+  int ch;
+  for (;;) {
+    while (isSpace(ch = readChar(R)))
+      ;
+    if (ch != 'c')
+      return ch;
+    skipLine(R);
+  }
+}
+
+// Read an integer whose first character is ch
+static int readInt(reader_t *R, int ch) {
+  int sign = 1;
+  if (ch == '-') {
+    sign = -1;
+    ch = readChar(R);
+  }
+  if (ch < '0' || ch > '9')
+    parseError(R, "expected a number");
+  long long value = ch - '0';
+  // Scan the digits window by window through local pointers
+  for (;;) {
+    const char *p = R->pos, *end = R->end;
+    while (p < end && *p >= '0' && *p <= '9') {
+      value = value * 10 + (*(p++) - '0');
+      if (value > INT_MAX)
+        parseError(R, "number out of range");
+    }
+    R->pos = p;
+    if (p < end || !R->refill(R))
+      break;
+  }
+  ch = readChar(R);
+  // Numbers are separated by white space
+  if (ch != EOF && !isSpace(ch))
+    parseError(R, "expected a number");
+  return sign * (int)value;
+}
+
+// Skip everything up to the "p cnf <nVars> <nClauses>" line
+static void readHeader(reader_t *R, int *nVars, int *nClauses) {
+  int ch;
+  while ((ch = nextToken(R)) != 'p') {
+    if (ch == EOF)
+      parseError(R, "missing p cnf header");
+    // Skip the unexpected token
+    while ((ch = readChar(R)) != EOF && !isSpace(ch))
+      ;
+  }
+  while (isSpace(ch = readChar(R)))
+    ;
+  if (ch != 'c' || readChar(R) != 'n' || readChar(R) != 'f' ||
+      !isSpace(readChar(R)))
+    parseError(R, "expected p cnf header");
+  *nVars = readInt(R, nextToken(R));
+  *nClauses = readInt(R, nextToken(R));
+}
+
+// Normalization of the clauses while they are loaded
+// stamp[var] is +id or -id if var occurs positively or negatively in
+// the clause with number id; only clauses longer than SHORT_CLAUSE are
+// stamped, shorter ones are scanned, which avoids random accesses.
+// The table holds the offsets of the loaded clauses with at least two
+// literals by the hash of their literal set.
+#define SHORT_CLAUSE 8
+
+struct entry {
+  uint32_t hash;
+  ref_t clause;
+};
+
+typedef struct loader {
+  int *stamp, id, stamped;
+  struct entry *table;
+  size_t capacity, count;
+} loader_t;
+
+static int newLoader(solver_t *S) {
+  loader_t *L = calloc(1, sizeof(loader_t));
+  if (L == NULL)
+    return MEMOUT;
+  // Size the table for the clauses of the header, up to a limit
+  L->capacity = 1024;
+  while (L->capacity < (size_t)S->nClauses + S->nClauses / 3 &&
+         L->capacity < (1 << 24))
+    L->capacity *= 2;
+  L->stamp = calloc(S->nVars + 1, sizeof(int));
+  L->table = calloc(L->capacity, sizeof(struct entry));
+  S->loader = L;
+  return L->stamp && L->table ? SAT : MEMOUT;
+}
+
+static void freeLoader(solver_t *S) {
+  if (S->loader == NULL)
+    return;
+  free(S->loader->stamp);
+  free(S->loader->table);
+  free(S->loader);
+  S->loader = NULL;
+}
+
+// Hash of a literal; the hash of a clause is the sum over its literals
+// and does not depend on their order
+static inline uint64_t hashLiteral(int lit) {
+  uint64_t x = (uint32_t)lit * 0x9E3779B97F4A7C15ULL;
+  x ^= x >> 29;
+  x *= 0xBF58476D1CE4E5B9ULL;
+  return x ^ (x >> 32);
+}
+
+// Return 1 if lit and -1 if -lit is among the first size literals of
+// the current clause in S->buffer, 0 otherwise
+static inline int occurs(solver_t *S, int lit, int size) {
+  loader_t *L = S->loader;
+  if (L->stamped) {
+    int stamp = L->stamp[abs(lit)], id = lit > 0 ? L->id : -L->id;
+    return stamp == id ? 1 : stamp == -id ? -1 : 0;
+  }
+  for (int i = 0; i < size; i++)
+    if (S->buffer[i] == lit)
+      return 1;
+    else if (S->buffer[i] == -lit)
+      return -1;
+  return 0;
+}
+
+// Determine whether the clause at offset ref has exactly the size
+// literals of the current clause
+static int sameClause(solver_t *S, ref_t ref, int size) {
+  int *lits = S->DB + ref;
+  for (int i = 0; i < size; i++)
+    if (occurs(S, lits[i], size) != 1)
+      return 0;
+  return lits[size] == 0;
+}
+
+// Return the slot of an identical clause, or the empty slot for it
+static struct entry *findClause(solver_t *S, uint32_t hash, int size) {
+  loader_t *L = S->loader;
+  size_t mask = L->capacity - 1, i = hash & mask;
+  for (;; i = (i + 1) & mask) {
+    struct entry *e = &L->table[i];
+    if (!e->clause || (e->hash == hash && sameClause(S, e->clause, size)))
+      return e;
+  }
+}
+
+// Double the table once it is three quarters full
+static int growTable(loader_t *L) {
+  if (4 * (L->count + 1) <= 3 * L->capacity)
+    return SAT;
+  size_t capacity = 2 * L->capacity, mask = capacity - 1;
+  struct entry *table = calloc(capacity, sizeof(struct entry));
+  if (table == NULL)
+    return MEMOUT;
+  for (size_t i = 0; i < L->capacity; i++) {
+    struct entry e = L->table[i];
+    if (!e.clause)
+      continue;
+    size_t j = e.hash & mask;
+    while (table[j].clause)
+      j = (j + 1) & mask;
+    table[j] = e;
+  }
+  free(L->table);
+  L->table = table;
+  L->capacity = capacity;
+  return SAT;
+}
+
+// Add the clause in S->buffer to the database
+// Repeated literals are removed, tautologies and duplicate clauses
+// are dropped (and counted in S->removedClauses/removedLiterals)
+// Return UNSAT for an empty clause or a conflicting unit
+int loadClause(solver_t *S, int size) {
+  if (S->loader == NULL && newLoader(S) != SAT)
+    return MEMOUT;
+  loader_t *L = S->loader;
+  // Start a new stamp, clearing the stamps when the ids run out
+  if ((L->stamped = size > SHORT_CLAUSE)) {
+    if (L->id == INT_MAX) {
+      memset(L->stamp, 0, sizeof(int) * (S->nVars + 1));
+      L->id = 0;
+    }
+    L->id++;
+  }
+  int kept = 0;
+  uint64_t hash = 0;
+  for (int i = 0; i < size; i++) {
+    int lit = S->buffer[i], seen = occurs(S, lit, kept);
+    // Skip a repeated literal
+    if (seen > 0)
+      continue;
+    // Drop a clause with both lit and -lit
+    if (seen < 0) {
+      S->removedClauses++;
+      S->removedLiterals += size;
+      return SAT;
+    }
+    if (L->stamped)
+      L->stamp[abs(lit)] = lit > 0 ? L->id : -L->id;
+    S->buffer[kept++] = lit;
+    hash += hashLiteral(lit);
+  }
+  S->removedLiterals += size - kept;
+  size = kept;
+  // Drop a unit that is already true, or a duplicate clause
+  struct entry *slot = NULL;
+  int duplicate = size == 1 && S->falseMark[-S->buffer[0]];
+  if (size > 1) {
+    if (growTable(L) != SAT)
+      return MEMOUT;
+    slot = findClause(S, (uint32_t)hash, size);
+    duplicate = slot->clause != 0;
+  }
+  if (duplicate) {
+    S->removedClauses++;
+    S->removedLiterals += size;
+    return SAT;
+  }
+  int *clause = addClause(S, S->buffer, size, 1);
+  if (clause == NULL)
+    return MEMOUT;
+  if (slot) {
+    slot->hash = (uint32_t)hash;
+    slot->clause = clause - S->DB;
+    L->count++;
+  }
+  // Check for empty clause or conflicting unit
+  if (!size || ((size == 1) && S->falseMark[clause[0]]))
+    // If either is found return UNSAT
+    return UNSAT;
+  // Check for a new unit
+  if ((size == 1) && !S->falseMark[-clause[0]])
+    // Directly assign new units (forced = 1)
+    assign(S, clause, 1);
+  return SAT;
+}
+
+// Append lit to the clause in S->buffer, a zero loads the clause
+static inline int addLiteral(solver_t *S, int lit, int *size) {
+  if (!lit) {
+    int res = loadClause(S, *size);
+    // Reset buffer
+    *size = 0;
+    return res;
+  }
+  if (*size == S->nVars)
+    fail("clause exceeds the number of variables");
+  // Add literal to buffer
+  S->buffer[(*size)++] = lit;
+  return SAT;
+}
+
+// Parse the clauses from R
+static int parseClauses(solver_t *S, reader_t *R) {
+  // Initialize the number of clauses to read
+  int nZeros = S->nClauses, size = 0;
+  // While there are clauses in the file
+  while (nZeros > 0) {
+    int ch = nextToken(R);
+    // A missing final zero still ends the clause
+    if (ch == EOF)
+      return size ? loadClause(S, size) : SAT;
+    int lit = readInt(R, ch);
+    if (abs(lit) > S->nVars)
+      parseError(R, "literal exceeds the number of variables");
+    int res = addLiteral(S, lit, &size);
+    if (res != SAT)
+      return res;
+    // If reaching the end of the clause
+    if (!lit)
+      --nZeros;
+  }
+  // Return that no conflict was observed
+  return SAT;
+}
+
+// Inputs are split into chunks of at least this many bytes
+#define MIN_CHUNK (4 << 20)
+
+// A newline aligned part of the input which is tokenized by its own
+// thread into lits; zeros in lits terminate the clauses
+typedef struct chunk {
+  reader_t R;
+  jmp_buf onError;
+  pthread_t thread;
+  int nVars, *lits;
+  size_t size, capacity;
+} chunk_t;
+
+static void *tokenizeChunk(void *arg) {
+  chunk_t *C = arg;
+  reader_t *R = &C->R;
+  // Stop at the first error; it is only reported if the clauses
+  // before it do not complete the formula
+  if (setjmp(C->onError))
+    return NULL;
+  int ch;
+  while ((ch = nextToken(R)) != EOF) {
+    int lit = readInt(R, ch);
+    if (abs(lit) > C->nVars)
+      parseError(R, "literal exceeds the number of variables");
+    if (C->size == C->capacity) {
+      C->capacity = C->capacity ? 2 * C->capacity : 1 << 16;
+      C->lits = realloc(C->lits, C->capacity * sizeof(int));
+      if (C->lits == NULL)
+        parseError(R, "out of memory");
+    }
+    C->lits[C->size++] = lit;
+  }
+  return NULL;
+}
+
+// Tokenize the clauses in [begin, end) with n threads. The chunks are
+// loaded in file order, so the database does not depend on n.
+static int parseParallel(solver_t *S, const char *begin, const char *end,
+                         int n) {
+  chunk_t *chunks = calloc(n, sizeof(chunk_t));
+  if (chunks == NULL)
+    fail("out of memory");
+  const char *from = begin;
+  for (int i = 0; i < n; i++) {
+    chunk_t *C = &chunks[i];
+    const char *to = end;
+    if (i < n - 1) {
+      // Split after the first new line past an equal share
+      to = begin + (end - begin) / n * (i + 1);
+      if (to < from)
+        to = from;
+      const char *nl = memchr(to, '\n', end - to);
+      to = nl ? nl + 1 : end;
+    }
+    C->R = (reader_t){.pos = from, .end = to, .refill = noRefill,
+                      .onError = &C->onError};
+    C->nVars = S->nVars;
+    if (pthread_create(&C->thread, NULL, tokenizeChunk, C))
+      fail("cannot create thread");
+    from = to;
+  }
+  int nZeros = S->nClauses, size = 0, res = SAT;
+  for (int i = 0; i < n; i++) {
+    chunk_t *C = &chunks[i];
+    pthread_join(C->thread, NULL);
+    // Load the clauses of the chunk while more are expected
+    for (size_t j = 0; j < C->size && nZeros > 0 && res == SAT; j++) {
+      res = addLiteral(S, C->lits[j], &size);
+      if (!C->lits[j])
+        --nZeros;
+    }
+    if (nZeros > 0 && res == SAT && C->R.error)
+      fail(C->R.error);
+    free(C->lits);
+  }
+  // A missing final zero still ends the clause
+  if (nZeros > 0 && res == SAT && size)
+    res = loadClause(S, size);
+  free(chunks);
+  return res;
+}
+
+// An input file; regular files are mapped into memory
+typedef struct input {
+  int fd;
+  const char *data;
+  size_t size;
+} input_t;
+
+static void openInput(char *filename, input_t *in) {
+  in->fd = strcmp(filename, "-") ? open(filename, O_RDONLY) : STDIN_FILENO;
+  if (in->fd < 0) {
+    printf("c cannot open %s\n", filename);
+    exit(1);
+  }
+  in->data = NULL;
+  in->size = 0;
+  struct stat st;
+  if (!fstat(in->fd, &st) && S_ISREG(st.st_mode) && st.st_size > 0) {
+    char *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, in->fd, 0);
+    if (data != MAP_FAILED) {
+      // The file is read front to back
+      posix_madvise(data, st.st_size, POSIX_MADV_SEQUENTIAL);
+      in->data = data;
+      in->size = st.st_size;
+    }
+  }
+}
+
+static void closeInput(input_t *in) {
+  if (in->data)
+    munmap((char *)in->data, in->size);
+  if (in->fd != STDIN_FILENO)
+    close(in->fd);
+}
+
+// Set up R to read the text of in; plain mapped files are
+// tokenized in place, everything else is decoded by a stream
+static void openReader(input_t *in, reader_t *R) {
+  if (in->data && compressionFormat((const unsigned char *)in->data,
+                                    in->size) == PLAIN)
+    *R = (reader_t){.pos = in->data,
+                    .end = in->data + in->size,
+                    .refill = noRefill};
+  else
+    *R = (reader_t){.refill = streamRefill, .stream = openStream(in->fd)};
+}
+
+// Release R and add the time spent by its stream to the timers
+static void closeReader(reader_t *R, double *decompressTime,
+                        double *waitTime) {
+  if (R->stream)
+    closeStream(R->stream, decompressTime, waitTime);
+}
+
+// Parse the text of in
+static int parseText(solver_t *S, input_t *in, double *decompressTime,
+                     double *waitTime) {
+  reader_t R;
+  openReader(in, &R);
+  int nVars, nClauses, res;
+  readHeader(&R, &nVars, &nClauses);
+  // Allocate the main datastructures; a literal takes at least two
+  // bytes of text and a clause one int beyond its literals
+  long long mem = (long long)nClauses + (R.end - R.pos) / 2;
+  res = initCDCL(S, nVars, nClauses, R.stream ? 0 : mem);
+  if (res != SAT) {
+    closeReader(&R, decompressTime, waitTime);
+    return res;
+  }
+  long threads = S->opt.threads;
+  if (threads == 0)
+    threads = sysconf(_SC_NPROCESSORS_ONLN);
+  if (threads > (R.end - R.pos) / MIN_CHUNK)
+    threads = (R.end - R.pos) / MIN_CHUNK;
+  if (threads > 1)
+    res = parseParallel(S, R.pos, R.end, (int)threads);
+  else
+    res = parseClauses(S, &R);
+  closeReader(&R, decompressTime, waitTime);
+  return res;
+}
+
+// Write the clauses of the text of in as binary CNF to out
+static int convertText(input_t *in, const char *out, uint64_t hash,
+                       double *decompressTime, double *waitTime) {
+  writer_t *W = openWriter(out);
+  if (W == NULL)
+    return -1;
+  reader_t R;
+  openReader(in, &R);
+  int nVars, nClauses, size = 0;
+  readHeader(&R, &nVars, &nClauses);
+  if (nVars < 0 || nClauses < 0)
+    fail("expected p cnf header");
+  int *lits = malloc((nVars + 1) * sizeof(int));
+  if (lits == NULL)
+    fail("out of memory");
+  // Read exactly the clauses parse would read
+  while (nClauses > 0) {
+    int ch = nextToken(&R);
+    if (ch == EOF) {
+      if (size)
+        writeClause(W, lits, size);
+      break;
+    }
+    int lit = readInt(&R, ch);
+    if (abs(lit) > nVars)
+      parseError(&R, "literal exceeds the number of variables");
+    if (!lit) {
+      writeClause(W, lits, size);
+      size = 0;
+      --nClauses;
+    } else {
+      if (size == nVars)
+        fail("clause exceeds the number of variables");
+      lits[size++] = lit;
+    }
+  }
+  free(lits);
+  closeReader(&R, decompressTime, waitTime);
+  return closeWriter(W, nVars, hash);
+}
+
+int convert(char *filename, char *out) {
+  input_t in;
+  openInput(filename, &in);
+  if (in.data && isBinary(in.data, in.size)) {
+    printf("c %s is already binary\n", filename);
+    exit(1);
+  }
+  double decompressTime, waitTime;
+  int res = convertText(&in, out, in.data ? hashBytes(in.data, in.size) : 0,
+                        &decompressTime, &waitTime);
+  closeInput(&in);
+  return res;
+}
+
+// Load the binary CNF cached next to a mapped text file,
+// after (re)creating it if it is missing or out of date
+static int parseCached(solver_t *S, char *filename, input_t *in,
+                       double *decompressTime, double *waitTime) {
+  uint64_t hash = hashBytes(in->data, in->size);
+  size_t length = strlen(filename);
+  char *path = malloc(length + 32), *tmp = malloc(length + 32);
+  if (path == NULL || tmp == NULL)
+    fail("out of memory");
+  sprintf(path, "%s.mcnf", filename);
+  input_t cache;
+  int valid = 0;
+  if (!access(path, R_OK)) {
+    openInput(path, &cache);
+    valid = cache.data && isBinary(cache.data, cache.size) &&
+            binaryHash(cache.data) == hash;
+    if (!valid)
+      closeInput(&cache);
+  }
+  if (!valid) {
+    // Write to a temporary file so other runs never see a partial cache
+    sprintf(tmp, "%s.%ld.tmp", path, (long)getpid());
+    if (convertText(in, tmp, hash, decompressTime, waitTime) ||
+        rename(tmp, path)) {
+      printf("c cannot write %s\n", path);
+      unlink(tmp);
+      free(path);
+      free(tmp);
+      return -1;
+    }
+    openInput(path, &cache);
+  }
+  int res = loadBinary(S, cache.data, cache.size);
+  closeInput(&cache);
+  free(path);
+  free(tmp);
+  return res;
+}
+
+// Parse the formula and initialize
+// Plain files are mapped into memory and tokenized in place, large
+// files by S->opt.threads threads. Pipes (FILE "-" is stdin) and
+// compressed files are decoded by a producer thread while parsing.
+// Binary CNF files are loaded directly; with S->opt.cache text files
+// are loaded from a binary copy next to them.
+int parse(solver_t *S, char *filename) {
+  double start = wallTime(), decompressTime = 0, waitTime = 0;
+  input_t in;
+  openInput(filename, &in);
+  int res = -1;
+  S->loader = NULL;
+  S->removedClauses = S->removedLiterals = 0;
+  if (in.data && isBinary(in.data, in.size))
+    res = loadBinary(S, in.data, in.size);
+  else if (in.data && S->opt.cache)
+    res = parseCached(S, filename, &in, &decompressTime, &waitTime);
+  if (res < 0)
+    res = parseText(S, &in, &decompressTime, &waitTime);
+  closeInput(&in);
+  freeLoader(S);
+  // Time spent waiting for the decompressor is not parse time
+  S->parseTime = wallTime() - start - waitTime;
+  S->decompressTime = decompressTime;
+  return res;
+}
+
+static void read_until_new_line(FILE *input) {
+  int ch;
+  while ((ch = getc(input)) != '\n')
+    if (ch == EOF) {
+      printf("parse error: unexpected EOF");
+      exit(1);
+    }
+}
+
+// Parse the formula and initialize
+int parseStdio(solver_t *S, char *filename) {
+  int tmp;
+  // Read the CNF file
+  FILE *input = fopen(filename, "r");
+  if (input == NULL) {
+    printf("c cannot open %s\n", filename);
+    exit(1);
+  }
+  while ((tmp = getc(input)) == 'c')
+    read_until_new_line(input);
+  ungetc(tmp, input);
+  do {
+    // Find the first non-comment line
+    tmp = fscanf(input, " p cnf %i %i \n", &S->nVars, &S->nClauses);
+    // In case a commment line was found
+    if (tmp > 0 && tmp != EOF)
+      break;
+    tmp = fscanf(input, "%*s\n");
+  }
+  // Skip it and read next line
+  while (tmp != 2 && tmp != EOF);
+  // Allocate the main datastructures
+  if (initCDCL(S, S->nVars, S->nClauses, 0) != SAT)
+    return MEMOUT;
+  // Initialize the number of clauses to read
+  int nZeros = S->nClauses, size = 0;
+  // While there are clauses in the file
+  while (nZeros > 0) {
+    int ch = getc(input);
+    if (ch == ' ' || ch == '\n')
+      continue;
+    if (ch == 'c') {
+      read_until_new_line(input);
+      continue;
+    }
+    ungetc(ch, input);
+    int lit = 0;
+    // Read a literal.
+    tmp = fscanf(input, " %i ", &lit);
+    // If reaching the end of the clause
+    if (!lit) {
+      // Then add the clause to data_base
+      int *clause = addClause(S, S->buffer, size, 1);
+      if (clause == NULL)
+        return MEMOUT;
+      // Check for empty clause or conflicting unit
+      if (!size || ((size == 1) && S->falseMark[clause[0]]))
+        // If either is found return UNSAT
+        return UNSAT;
+      // Check for a new unit
+      if ((size == 1) && !S->falseMark[-clause[0]]) {
+        // Directly assign new units (forced = 1)
+        assign(S, clause, 1);
+      }
+      // Reset buffer
+      size = 0;
+      --nZeros;
+    } else
+      // Add literal to buffer
+      S->buffer[size++] = lit;
+  }
+  // Close the formula file
+  fclose(input);
+  // Return that no conflict was observed
+  return SAT;
+}
@@ -1,8 +1,9 @@
-/**************************************************************[utils.h]*******
+/**************************************************************[dimacs.h]*****
 
   The MIT License
 
   Copyright (c) 2022 Guangchen Li
+  Copyright (c) 2014-2018 Marijn Heule
 
   Permission is hereby granted, free of charge, to any person obtaining a copy
   of this software and associated documentation files (the "Software"), to deal
@@ -24,4 +25,22 @@
 
 *******************************************************************************/
 
-char *itoa(int num, char *str, int base);
+#ifndef DIMACS
+#define DIMACS
+
+#include "microsat.h"
+
+// Add the clause of size literals in S->buffer to the database
+// Repeated literals are removed, tautologies and duplicate clauses
+// are dropped
+// Return UNSAT for an empty clause or a conflicting unit
+int loadClause(solver_t *, int size);
+
+// Write the formula in FILE as binary CNF, return 0 on success
+int convert(char *, char *);
+
+// Parse the formula with the original fscanf based reader
+// (not used by parse, kept as a reference point for bench/bench_parse.c)
+int parseStdio(solver_t *, char *);
+
+#endif
@@ -25,57 +25,232 @@
 
 *******************************************************************************/
 
+#include <limits.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
+#include "dimacs.h"
 #include "microsat.h"
-#include "utils.h"
 
 #define MAX_LINE_LEN 80
+// Size of the output buffer of the model writer
+#define OUT_SIZE (1 << 20)
+
+// Format num in decimal at p and return the end of the digits
+static inline char *formatInt(char *p, int num) {
+  char digits[16];
+  int n = 0;
+  unsigned int x = num < 0 ? -(unsigned int)num : (unsigned int)num;
+  if (num < 0)
+    *p++ = '-';
+  do
+    digits[n++] = '0' + x % 10;
+  while (x /= 10);
+  while (n)
+    *p++ = digits[--n];
+  return p;
+}
 
 // Print the model if satisfiable
+// The literals are formatted into a large buffer, in "v" lines of at
+// most MAX_LINE_LEN characters terminated by 0, and written in blocks
 void print_model(solver_t *S) {
-  char buffer[32];
-  size_t current_lit_len;
-  // Count the number of characters in the line
-  unsigned int line_count = 2;
-  printf("v ");
-  for (int i = 0; i < S->nVars; i++) {
-    itoa((S->model[i] ? i + 1 : -i - 1), buffer, 10);
-    current_lit_len = strlen(buffer);
-    // If max length is exceeded
-    if (current_lit_len + line_count > MAX_LINE_LEN) {
-      // Including the 'v ' and space after literal
-      line_count = current_lit_len + 3;
-      printf("\nv %s ", buffer);
-    } else {
-      line_count += current_lit_len + 1;
-      printf("%s", buffer);
-      // If there is remaining length for a space
-      if (current_lit_len + line_count + 1 <= MAX_LINE_LEN) {
-        printf(" ");
-      }
+  char *buffer = malloc(OUT_SIZE), *p = buffer, *line = buffer;
+  if (buffer == NULL) {
+    printf("c out of memory\n");
+    return;
+  }
+  *p++ = 'v';
+  for (int i = 1; i <= S->nVars + 1; i++) {
+    char lit[16];
+    // The 0 that terminates the model follows the last variable
+    int num = i > S->nVars ? 0 : S->model[i] ? i : -i;
+    size_t len = formatInt(lit, num) - lit;
+    // Start a new line if the literal does not fit on this one
+    if ((p - line) + 1 + len > MAX_LINE_LEN) {
+      *p++ = '\n';
+      line = p;
+      *p++ = 'v';
+    }
+    *p++ = ' ';
+    memcpy(p, lit, len);
+    p += len;
+    // Leave room for a new line and the next literal
+    if (p - buffer > OUT_SIZE - 2 * MAX_LINE_LEN) {
+      fwrite(buffer, 1, line - buffer, stdout);
+      memmove(buffer, line, p - line);
+      p -= line - buffer;
+      line = buffer;
     }
   }
-  printf("\n");
+  *p++ = '\n';
+  fwrite(buffer, 1, p - buffer, stdout);
+  free(buffer);
+}
+
+// Write the model to path as a bitset: bit (i - 1) % 8 of byte
+// (i - 1) / 8 is set if variable i is true. Return 0 on success
+static int write_bitset(solver_t *S, const char *path) {
+  size_t size = ((size_t)S->nVars + 7) / 8;
+  unsigned char *bits = calloc(size ? size : 1, 1);
+  FILE *file = fopen(path, "wb");
+  int res = bits == NULL || file == NULL;
+  if (!res) {
+    for (int i = 1; i <= S->nVars; i++)
+      if (S->model[i])
+        bits[(i - 1) / 8] |= 1 << (i - 1) % 8;
+    res = fwrite(bits, 1, size, file) != size;
+  }
+  if (file)
+    res |= fclose(file) != 0;
+  free(bits);
+  return res ? -1 : 0;
+}
+
+static void usage(char *name) {
+  printf("usage: %s [OPTIONS] [FILE]\n"
+         "  FILE may be gzip, xz or bzip2 compressed and defaults to stdin\n"
+         "  --threads=N    parse with N threads (default: one per core)\n"
+         "  --conflicts=N  stop after N conflicts\n"
+         "  --heuristic=H  decide with H = vmtf (default) or vsids\n"
+         "  --restarts=R   restart with R = ema (default), luby or geometric\n"
+         "  --ema-fast=N   ema: fast average over 2^N conflicts (5)\n"
+         "  --ema-slow=N   ema: slow average over 2^N conflicts (15)\n"
+         "  --margin=P     ema: restart when fast > P%% of slow (125)\n"
+         "  --block=P      ema: none while trail > P%% of average (0: off)\n"
+         "  --interval=N   luby, geometric: first interval (100)\n"
+         "  --factor=P     geometric: interval growth in percent (150)\n"
+         "  --modes=N      switch to stable mode after N conflicts (1000)\n"
+         "  --rephase=N    reset the phases after N conflicts (1000)\n"
+         "  --cache        load FILE through a binary copy FILE.mcnf\n"
+         "  --convert=OUT  write FILE as binary CNF to OUT and exit\n"
+         "  --bitset=OUT   write the model as a bitset to OUT\n",
+         name);
+  exit(1);
+}
+
+// Match arg against "--name=N" and store N (at most max) in value
+static int intOption(char *arg, const char *name, long max, int *value) {
+  size_t len = strlen(name);
+  if (strncmp(arg, name, len) || arg[len] != '=')
+    return 0;
+  char *end;
+  long n = strtol(arg + len + 1, &end, 10);
+  if (end == arg + len + 1 || *end || n < 0 || n > max) {
+    printf("c invalid value in %s\n", arg);
+    exit(1);
+  }
+  *value = (int)n;
+  return 1;
+}
+
+// Match arg against "--name=VALUE" and store the index of VALUE in the
+// NULL terminated names in value
+static int enumOption(char *arg, const char *name, const char *const *names,
+                      int *value) {
+  size_t len = strlen(name);
+  if (strncmp(arg, name, len) || arg[len] != '=')
+    return 0;
+  for (int i = 0; names[i]; i++)
+    if (!strcmp(arg + len + 1, names[i])) {
+      *value = i;
+      return 1;
+    }
+  printf("c invalid value in %s\n", arg);
+  exit(1);
 }
 
 // The main procedure for a STANDALONE solver
 int main(int argc, char **argv) {
   // Create the solver datastructure
   solver_t S;
-  // Parse the DIMACS file in argv[1]
-  if (parse(&S, argv[1]) == UNSAT) {
-    printf("s UNSATISFIABLE\n");
-    // Solve without limit (number of conflicts)
-  } else if (solve(&S) == UNSAT) {
+  char *file = "-", *out = NULL, *bitset = NULL;
+  defaultOptions(&S.opt);
+  // Indexed by VMTF and VSIDS
+  const char *const heuristics[] = {"vmtf", "vsids", NULL};
+  // Indexed by EMA, LUBY and GEOMETRIC
+  const char *const restarts[] = {"ema", "luby", "geometric", NULL};
+  for (int i = 1; i < argc; i++) {
+    if (intOption(argv[i], "--threads", 1 << 20, &S.opt.threads))
+      continue;
+    if (intOption(argv[i], "--conflicts", INT_MAX, &S.opt.conflicts))
+      continue;
+    if (enumOption(argv[i], "--heuristic", heuristics, &S.opt.heuristic))
+      continue;
+    if (enumOption(argv[i], "--restarts", restarts, &S.opt.restarts))
+      continue;
+    // The averages are fixed point numbers with 20 fractional bits
+    if (intOption(argv[i], "--ema-fast", 20, &S.opt.fast) ||
+        intOption(argv[i], "--ema-slow", 20, &S.opt.slow))
+      continue;
+    if (intOption(argv[i], "--margin", 1 << 20, &S.opt.margin) ||
+        intOption(argv[i], "--block", 1 << 20, &S.opt.block))
+      continue;
+    if (intOption(argv[i], "--interval", INT_MAX, &S.opt.interval) ||
+        intOption(argv[i], "--factor", 1 << 20, &S.opt.factor))
+      continue;
+    if (intOption(argv[i], "--modes", INT_MAX, &S.opt.modes) ||
+        intOption(argv[i], "--rephase", INT_MAX, &S.opt.rephase))
+      continue;
+    if (!strcmp(argv[i], "--cache")) {
+      S.opt.cache = 1;
+      continue;
+    }
+    if (!strncmp(argv[i], "--convert=", 10)) {
+      out = argv[i] + 10;
+      continue;
+    }
+    if (!strncmp(argv[i], "--bitset=", 9)) {
+      bitset = argv[i] + 9;
+      continue;
+    }
+    if (argv[i][0] == '-' && argv[i][1] == '-')
+      usage(argv[0]);
+    file = argv[i];
+  }
+  if (out) {
+    if (!convert(file, out))
+      return 0;
+    printf("c cannot write %s\n", out);
+    return 1;
+  }
+  // Parse the DIMACS file
+  int res = parse(&S, file);
+  // Solve without limit (number of conflicts)
+  if (res == SAT)
+    res = solve(&S);
+  if (res == UNSAT) {
     printf("s UNSATISFIABLE\n");
+  } else if (res == MEMOUT) {
+    printf("c out of memory\ns UNKNOWN\n");
+  } else if (res == UNKNOWN) {
+    printf("c conflict limit reached\ns UNKNOWN\n");
   } else {
     // And print whether the formula has a solution
     printf("s SATISFIABLE\nc \n");
-    // Print model
-    print_model(&S);
+    // Print model, or write it to the bitset file
+    if (!bitset)
+      print_model(&S);
+    else if (write_bitset(&S, bitset))
+      printf("c cannot write %s\n", bitset);
   }
-  printf("c \nc statistics of %s:\nc mem: %i conflicts: %i max_lemmas: %i\n",
-         argv[1], S.mem_used, S.nConflicts, S.maxLemmas);
+  printf("c \nc statistics of %s:\nc mem: %lld conflicts: %i max_lemmas: %i\n",
+         file, (long long)S.mem_used, S.nConflicts, S.maxLemmas);
+  printf("c propagations: %lld\n", S.nPropagations);
+  printf("c restarts (%s): %lld blocked: %lld stable: %lld\n",
+         restarts[S.opt.restarts], S.nRestarts, S.nBlocked, S.nStable);
+  printf("c focused: %.2f s stable: %.2f s switches: %lld\n", S.modeTime[0],
+         S.modeTime[1], S.nSwitches);
+  printf("c rephased: %lld original %lld inverted %lld best\n",
+         S.nRephased[ORIGINAL], S.nRephased[INVERTED], S.nRephased[BEST]);
+  printf("c minimized: %lld of %lld lemma literals (%.1f%%), %.2f us per "
+         "conflict\n",
+         S.nMinimized, S.nLemmaLiterals,
+         S.nLemmaLiterals ? 100.0 * S.nMinimized / S.nLemmaLiterals : 0.0,
+         S.nConflicts ? 1e6 * S.minimizeTime / S.nConflicts : 0.0);
+  printf("c removed at load: %lld clauses %lld literals\n", S.removedClauses,
+         S.removedLiterals);
+  printf("c parse time: %.2f s decompression time: %.2f s\n", S.parseTime,
+         S.decompressTime);
 }
@@ -26,49 +26,118 @@
 *******************************************************************************/
 
 #include "microsat.h"
+#include "stream.h"
+#include <limits.h>
 #include <stdio.h>
+#include <stdint.h>
 #include <stdlib.h>
 
+// Largest number of ints the database can address
+#define MAX_CELLS                                                              \
+  ((long long)(REF_MAX < SIZE_MAX / sizeof(int) ? REF_MAX                      \
+                                                : SIZE_MAX / sizeof(int)))
+
+// The average trail size for blocking restarts is taken over the last
+// 2^TRAIL_WINDOW conflicts, and blocks only after BLOCK_AFTER conflicts
+#define TRAIL_WINDOW 12
+#define BLOCK_AFTER 10000
+
+// Factor by which VSIDS decays the activities after each conflict
+#define VSIDS_DECAY 0.95f
+
+// Stable mode restarts after STABLE_INTERVAL times the Luby sequence
+#define STABLE_INTERVAL 1024
+
 // Unassign the literal
-void unassign(solver_t *S, int lit) { S->falseMark[lit] = 0; }
+void unassign(solver_t *S, int lit) {
+  int var = abs(lit);
+  S->falseMark[lit] = 0;
+  // For VSIDS, the unassigned variables are in the heap
+  if (S->heuristic == VSIDS) {
+    if (!rm_heap_in_heap(&S->heap, var))
+      rm_heap_push(&S->heap, var, S->activity[var]);
+  }
+  // For VMTF, the variables enqueued after search are all assigned
+  else if (S->stamp[var] > S->stamp[S->search])
+    S->search = var;
+}
 
 // Perform a restart (i.e., unassign all variables)
 void restart(solver_t *S) {
   // Remove all unforced false lits from falseStack
   while (S->assigned > S->forced)
     unassign(S, *(--S->assigned));
+  S->nDecisions = 0;
   // Reset the processed pointer
   S->processed = S->forced;
+  // The target phases are those of the trails since the last restart
+  S->targetAssigned = 0;
 }
 
-// Make the first literal of the reason true
-void assign(solver_t *S, int *reason, int forced) {
-  // Let lit be the first literal in the reason
-  int lit = reason[0];
+// The reason of a literal implied by a binary clause is the other
+// (false) literal of the clause, stored as -(2 * |other| + (other < 0))
+static inline ref_t binaryReason(int other) {
+  return -(2 * (ref_t)abs(other) + (other < 0));
+}
+
+static inline int reasonLiteral(ref_t reason) {
+  int var = (int)(-reason >> 1);
+  return -reason & 1 ? -var : var;
+}
+
+// Make lit true with the given reason
+static void setTrue(solver_t *S, int lit, ref_t reason, int forced) {
   // Mark lit as true and IMPLIED if forced
   S->falseMark[-lit] = forced ? IMPLIED : 1;
-  // Push it on the assignment stack
+  // Push it on the assignment stack, on the current decision level
+  S->level[abs(lit)] = S->nDecisions;
   *(S->assigned++) = -lit;
   // Set the reason clause of lit
-  S->reason[abs(lit)] = 1 + (int)((reason)-S->DB);
+  S->reason[abs(lit)] = reason;
   // Mark the literal as true in the model
   S->model[abs(lit)] = (lit > 0);
 }
 
-// Add a watch pointer to a clause containing lit
-// By updating the database and the pointers
-// mem: offset of the watch lit in DB
-void addWatch(solver_t *S, int lit, int mem) {
-  S->DB[mem] = S->first[lit];
-  S->first[lit] = mem;
+// Make the first literal of the reason true
+void assign(solver_t *S, int *reason, int forced) {
+  setTrue(S, reason[0], 1 + (ref_t)((reason)-S->DB), forced);
 }
 
-// Allocate memory of size mem_size
+// Add a watch of lit to the clause at offset clause in DB, with the
+// other watched literal as blocker
+// Return MEMOUT if the watch list of lit cannot grow
+int addWatch(solver_t *S, int lit, ref_t clause, int blocker) {
+  watches_t *ws = &S->watches[lit];
+  if (ws->size == ws->capacity) {
+    int capacity = ws->capacity ? 2 * ws->capacity : 4;
+    watch_t *list = realloc(ws->list, sizeof(watch_t) * capacity);
+    if (list == NULL)
+      return MEMOUT;
+    ws->list = list;
+    ws->capacity = capacity;
+  }
+  ws->list[ws->size++] = (watch_t){clause, blocker};
+  return SAT;
+}
+
+// Allocate memory of size mem_size in the database
+// Return NULL if the database cannot grow any further
 int *getMemory(solver_t *S, int mem_size) {
-  // In case the code is used within a code base
-  if (S->mem_used + mem_size > S->mem_max) {
-    printf("c out of memory\n");
-    exit(0);
+  long long needed = (long long)S->mem_used + mem_size;
+  if (needed > S->mem_max) {
+    // Grow geometrically; clauses are referenced by their offset,
+    // so moving the database keeps all references valid
+    long long mem_max =
+        S->mem_max < MAX_CELLS / 2 ? 2 * (long long)S->mem_max : MAX_CELLS;
+    if (mem_max < needed)
+      mem_max = needed;
+    if (needed > MAX_CELLS)
+      return NULL;
+    int *DB = (int *)realloc(S->DB, sizeof(int) * mem_max);
+    if (DB == NULL)
+      return NULL;
+    S->DB = DB;
+    S->mem_max = (ref_t)mem_max;
   }
   // Compute a pointer to the new memory location
   int *store = (S->DB + S->mem_used);
@@ -80,18 +149,22 @@ int *getMemory(solver_t *S, int mem_size) {
 
 // Adds a clause stored in *in of size size
 // irr: mark if the clause is irreducible(?)
+// Return NULL if the database is out of memory
 int *addClause(solver_t *S, int *in, int size, int irr) {
   // Store a pointer to the beginning of the clause
-  int i, used = S->mem_used;
+  int i;
+  ref_t used = S->mem_used;
   // Allocate memory for the clause in the database
-  // First two mem slot are watch literals
-  int *clause = getMemory(S, size + 3) + 2;
+  int *clause = getMemory(S, size + 1);
+  if (clause == NULL)
+    return NULL;
   // If the clause is not unit, then add
-  // Two watch pointers to the datastructure
-  if (size > 1) {
-    addWatch(S, in[0], used);
-    addWatch(S, in[1], used + 1);
-  }
+  // Two watches to the datastructure
+  // Binary clauses are watched implicitly, flagged by a negative offset
+  ref_t watch = size == 2 ? -used : used;
+  if (size > 1 && (addWatch(S, in[0], watch, in[1]) != SAT ||
+                   addWatch(S, in[1], watch, in[0]) != SAT))
+    return NULL;
   // Copy the clause from the buffer to the database
   for (i = 0; i < size; i++)
     clause[i] = in[i];
@@ -113,30 +186,25 @@ void reduceDB(solver_t *S, int k) {
     // Reset the number of lemmas
     S->nLemmas = 0;
   }
-  int i;
-  // Loop over the variables
-  for (i = -S->nVars; i <= S->nVars; i++) {
-    if (i == 0)
-      continue;
-    // Get the pointer to the first watched clause
-    int *watch = &S->first[i];
-    // As long as there are watched clauses
-    while (*watch != END) {
-      // Remove the watch if it points to a lemma
-      if (*watch < S->mem_fixed)
-        watch = (S->DB + *watch);
-      // Otherwise (meaning an input clause) go to next watch
-      else
-        *watch = S->DB[*watch];
-    }
+  // Loop over the literals
+  for (int i = -S->nVars; i <= S->nVars; i++) {
+    watches_t *ws = &S->watches[i];
+    int size = 0;
+    // Keep the watches of input clauses, remove those of lemmas
+    for (int j = 0; j < ws->size; j++)
+      if (ws->list[j].clause < S->mem_fixed &&
+          -ws->list[j].clause < S->mem_fixed)
+        ws->list[size++] = ws->list[j];
+    ws->size = size;
   }
-  int old_used = S->mem_used;
+  ref_t old_used = S->mem_used;
   S->mem_used = S->mem_fixed;
   // Virtually remove all lemmas
   // While the old memory contains lemmas
-  for (i = S->mem_fixed + 2; i < old_used; i += 3) {
+  for (ref_t i = S->mem_fixed; i < old_used; i++) {
     // Get the lemma to which the head is pointing
-    int count = 0, head = i;
+    int count = 0;
+    ref_t head = i;
     // Count the number of literals
     // That are satisfied by the current model
     while (S->DB[i]) {
@@ -144,50 +212,123 @@ void reduceDB(solver_t *S, int k) {
       if ((lit > 0) == S->model[abs(lit)])
         count++;
     }
-    // If the latter is smaller than k, add it back
+    // If the latter is smaller than k, add it back. It moves to a
+    // lower offset, and its watches fit in the lists
     if (count < k)
       addClause(S, S->DB + head, i - head, 0);
   }
 }
 
-// Move the variable to the front of the decision list
-void bump(solver_t *S, int lit) {
+// Increase the activity of var for VSIDS
+static void bumpActivity(solver_t *S, int var) {
+  if ((S->activity[var] += S->increment) > 1e20f) {
+    // Scale all activities down before they overflow, this keeps
+    // their order and so the heap
+    for (int i = 1; i <= S->nVars; i++)
+      S->activity[i] *= 1e-20f;
+    rm_heap_scale(&S->heap, 1e-20f);
+    S->increment *= 1e-20f;
+  }
+  // The heap is updated at the end of analyze
+  rm_heap_batch_set(&S->heap, var, S->activity[var]);
+}
+
+// Move the variable to the front of the decision list, or increase
+// its activity once per conflict for VSIDS
+// Return 1 if lit is newly MARKed on the current decision level
+int bump(solver_t *S, int lit) {
+  int open = 0;
   // MARK the literal as involved if not a top-level unit
   if (S->falseMark[lit] != IMPLIED) {
-    S->falseMark[lit] = MARK;
     int var = abs(lit);
+    // List it, so that analyze can reset the marks
+    if (S->falseMark[lit] != MARK) {
+      S->marked[S->nMarked++] = lit;
+      open = S->level[var] == S->nDecisions;
+      if (S->heuristic == VSIDS)
+        bumpActivity(S, var);
+    }
+    S->falseMark[lit] = MARK;
     // In case var is not already the head of the list
-    if (var != S->head) {
+    if (S->heuristic == VMTF && var != S->head) {
       S->prev[S->next[var]] = S->prev[var]; // Update the prev link
       S->next[S->prev[var]] = S->next[var]; // Update the next link
       S->next[S->head] = var;               // Add a next link to the head
       S->prev[var] = S->head;               // Make var the new head
       S->head = var;
+      // var is assigned, so search stays until var is unassigned
+      S->stamp[var] = ++S->nStamps;
     }
   }
+  return open;
 }
 
-// Check if lit(eral) is implied by MARK literals
-int implied(solver_t *S, int lit) {
+// A literal whose reason implied() is checking, and the next literal
+// of that reason to check
+struct frame {
+  int lit, *next, binary[2];
+};
+
+// The bit of level in an abstraction of a set of levels
+static inline unsigned levelBit(int level) { return 1u << (level & 31); }
+
+// Push lit on the stack of implied(), to check its reason
+static struct frame *enter(solver_t *S, struct frame *frame, int lit) {
+  ref_t reason = S->reason[abs(lit)];
+  // The result is stored in falseMark[lit], list lit for the reset
+  if (S->falseMark[lit] != MARK)
+    S->marked[S->nMarked++] = lit;
+  frame->lit = lit;
+  // Get the reason of lit(eral), a binary reason is not in DB
+  frame->binary[0] = reasonLiteral(reason);
+  frame->binary[1] = 0;
+  frame->next = reason > 0 ? S->DB + reason : frame->binary;
+  return frame;
+}
+
+// Check if lit(eral) is implied by MARK literals, whose levels are
+// abstracted in levels. Instead of recursing, the reasons being checked
+// are kept on S->stack
+int implied(solver_t *S, int lit, unsigned levels) {
   // If checked before return old result
   if (S->falseMark[lit] > MARK)
     return (S->falseMark[lit] & MARK);
   // In case lit is a decision, it is not implied
   if (!S->reason[abs(lit)])
     return 0;
-  // Get the reason of lit(eral)
-  int *p = (S->DB + S->reason[abs(lit)] - 1);
-  // While there are literals in the reason
-  while (*(++p))
-    // Recursively check if non-MARK literals are implied
-    if ((S->falseMark[*p] ^ MARK) && !implied(S, *p)) {
-      // Mark and return not implied (denoted by IMPLIED - 1)
-      S->falseMark[lit] = IMPLIED - 1;
-      return 0;
+  struct frame *top = enter(S, S->stack, lit);
+  for (;;) {
+    int p = *(top->next++);
+    if (!p) {
+      // All literals in the reason are implied, so is top->lit
+      S->falseMark[top->lit] = IMPLIED;
+      if (top == S->stack)
+        return 1;
+      top--;
+      continue;
     }
-  // Mark and return that the literal is implied
-  S->falseMark[lit] = IMPLIED;
-  return 1;
+    // Skip MARK literals and literals known to be implied
+    if (S->falseMark[p] == MARK || S->falseMark[p] == IMPLIED)
+      continue;
+    // Decisions and literals on levels without MARK literals are not
+    // implied, nor are literals checked before
+    if (S->falseMark[p] == IMPLIED - 1 || !S->reason[abs(p)] ||
+        !(levels & levelBit(S->level[abs(p)])))
+      break;
+    top = enter(S, top + 1, p);
+  }
+  // Mark the literals on the stack as not implied (IMPLIED - 1)
+  for (; top >= S->stack; top--)
+    S->falseMark[top->lit] = IMPLIED - 1;
+  return 0;
+}
+
+// Save the phases of the first n literals on falseStack in phases
+static void savePhases(solver_t *S, int *phases, int n) {
+  for (int i = 0; i < n; i++) {
+    int var = abs(S->falseStack[i]);
+    phases[var] = S->model[var] ? 1 : -1;
+  }
 }
 
 // Compute a resolvent from falsified clause
@@ -195,64 +336,114 @@ int *analyze(solver_t *S, int *clause) {
   // Bump restarts and update the statistic
   S->res++;
   S->nConflicts++;
-  // MARK all literals in the falsified clause
+  // The literals below the conflict level are free of conflicts, keep
+  // their phases if the trail is the longest so far
+  int consistent = S->decisions[S->nDecisions - 1];
+  if (S->stable && consistent > S->targetAssigned) {
+    savePhases(S, S->target, consistent);
+    S->targetAssigned = consistent;
+  }
+  if (S->opt.rephase && consistent > S->bestAssigned) {
+    savePhases(S, S->best, consistent);
+    S->bestAssigned = consistent;
+  }
+  // Update the average trail size, starting from the first one
+  S->lastTrail = (int)(S->assigned - S->falseStack);
+  if (S->nConflicts == 1)
+    S->trail = (long long)S->lastTrail << TRAIL_WINDOW;
+  S->trail -= S->trail >> TRAIL_WINDOW;
+  S->trail += S->lastTrail;
+  // Decay all activities by growing the increment instead
+  if (S->heuristic == VSIDS)
+    S->increment *= 1 / VSIDS_DECAY;
+  // MARK all literals in the falsified clause, open counts the MARK
+  // literals of the conflict level
+  int open = 0;
   while (*clause)
-    bump(S, *(clause++));
-  // Loop on variables on falseStack
-  // until the last decision
-  while (S->reason[abs(*(--S->assigned))]) {
+    open += bump(S, *(clause++));
+  // Loop on variables on falseStack until the first-UIP, the last
+  // MARK literal of the conflict level
+  for (;;) {
     // If the tail of the stack is MARK
-    if (S->falseMark[*S->assigned] == MARK) {
-      // Pointer to check if first-UIP is reached
-      int *check = S->assigned;
-      // Check for a MARK literal before decision
-      while (S->falseMark[*(--check)] != MARK)
-        // Otherwise it is the first-UIP so break
-        if (!S->reason[abs(*check)])
-          goto build;
+    if (S->falseMark[*(--S->assigned)] == MARK) {
+      if (--open == 0)
+        break;
       // Get the reason and
       // ignore first literal
-      clause = S->DB + S->reason[abs(*S->assigned)];
+      ref_t reason = S->reason[abs(*S->assigned)];
+      int binary[2] = {reasonLiteral(reason), 0};
+      clause = reason > 0 ? S->DB + reason : binary;
       // MARK all literals in reason
       while (*clause)
-        bump(S, *(clause++));
+        open += bump(S, *(clause++));
     }
     // Unassign the tail of the stack
     unassign(S, *S->assigned);
   }
 
-build:;
-  // Build conflict clause; Empty the clause buffer
-  int size = 0, lbd = 0, flag = 0;
-
-  int *p = S->processed = S->assigned;
-  // Loop from tail to front
-  while (p >= S->forced) {
-    // Only literals on the stack can be MARKed
+  // Build conflict clause from the first-UIP and the listed MARK
+  // literals below it (the literals above it are unassigned already)
+  int uip = *S->assigned, size = 1, lbd = 1, back = 0;
+  S->buffer[0] = uip;
+  S->levelSeen[S->nDecisions] = S->nConflicts;
+  // Abstract the levels of the MARK literals for implied()
+  unsigned levels = 0;
+  int nMarked = S->nMarked, nLits = 0;
+  for (int i = 0; i < nMarked; i++)
+    if (S->falseMark[S->marked[i]] == MARK) {
+      levels |= levelBit(S->level[abs(S->marked[i])]);
+      nLits++;
+    }
+  double start = wallTime();
+  // Literals listed by implied() during the loop are not MARK
+  for (int i = 0; i < nMarked; i++) {
+    int lit = S->marked[i];
     // If MARKed and not implied
-    if ((S->falseMark[*p] == MARK) && !implied(S, *p)) {
-      // Add literal to conflict clause buffer
-      S->buffer[size++] = *p;
-      flag = 1;
+    if (S->falseMark[lit] != MARK || lit == uip)
+      continue;
+    // Keep lit MARK for the calls on the other literals, as the walk
+    // from the top of falseStack did
+    int redundant = implied(S, lit, levels);
+    S->falseMark[lit] = MARK;
+    if (redundant)
+      continue;
+    // Add literal to conflict clause buffer
+    S->buffer[size++] = lit;
+    int level = S->level[abs(lit)];
+    // Increase LBD for a new level
+    if (S->levelSeen[level] != S->nConflicts) {
+      S->levelSeen[level] = S->nConflicts;
+      lbd++;
     }
-    if (!S->reason[abs(*p)]) {
-      // Increase LBD for a decision with a true flag
-      lbd += flag;
-      flag = 0;
-      // And update the processed pointer
-      if (size == 1)
-        S->processed = p;
+    // Keep the literal of the highest level at buffer[1], it is the
+    // level to jump back to
+    if (level > back) {
+      back = level;
+      S->buffer[size - 1] = S->buffer[1];
+      S->buffer[1] = lit;
     }
-    // Reset the MARK flag for all variables on the stack
-    S->falseMark[*(p--)] = 1;
   }
+  S->minimizeTime += wallTime() - start;
+  S->nLemmaLiterals += nLits;
+  S->nMinimized += nLits - size;
+  // Reset the MARK flags (and results of implied) of the listed literals
+  for (int i = 0; i < S->nMarked; i++)
+    if (S->falseMark[S->marked[i]])
+      S->falseMark[S->marked[i]] = 1;
+  S->nMarked = 0;
+  // Jump back to level back: unassign from its next decision on
+  S->processed = S->falseStack + S->decisions[back];
+  S->nDecisions = back;
 
+  // Start both moving averages from the first LBD
+  if (S->nConflicts == 1)
+    S->fast = S->slow = lbd << 20;
   // Update the fast moving average
-  S->fast -= S->fast >> 5;
-  S->fast += lbd << 15;
+  S->fast -= S->fast >> S->opt.fast;
+  S->fast += lbd << (20 - S->opt.fast);
   // Update the slow moving average
-  S->slow -= S->slow >> 15;
-  S->slow += lbd << 5;
+  S->slow -= S->slow >> S->opt.slow;
+  S->slow += lbd << (20 - S->opt.slow);
 
   // Loop over all unprocessed literals
   while (S->assigned > S->processed)
@@ -260,6 +451,9 @@ build:;
     unassign(S, *(S->assigned--));
   // Assigned now equal to processed
   unassign(S, *S->assigned);
+  // Move the bumped variables up in the heap
+  if (S->heuristic == VSIDS)
+    rm_heap_batch_end(&S->heap);
   // Terminate the buffer (and potentially print clause)
   S->buffer[size] = 0;
   // Add new conflict clause to redundant DB
@@ -269,66 +463,91 @@ build:;
 // Performs unit propagation
 int propagate(solver_t *S) {
   // Initialize forced flag
-  int forced = S->reason[abs(*S->processed)];
+  int forced = S->reason[abs(*S->processed)] != 0;
   // While unprocessed false literals
   while (S->processed < S->assigned) {
     // Get first unprocessed literal
     int lit = *(S->processed++);
-    // Obtain the first watch pointer
-    int *watch = &S->first[lit];
-    // While there are watched clauses (watched by lit)
-    while (*watch != END) {
-      // Let's assume that the clause is unit
-      int i, unit = 1;
+    S->nPropagations++;
+    // Walk the watches of lit, keeping the remaining ones in place
+    watches_t *ws = &S->watches[lit];
+    watch_t *i = ws->list, *j = ws->list, *end = ws->list + ws->size;
+    int *conflict = NULL;
+    while (i < end) {
+      watch_t w = *(i++);
+      // If the blocker is true the clause is satisfied
+      if (S->falseMark[-w.blocker]) {
+        *(j++) = w;
+        continue;
+      }
+      // The blocker of a binary clause is its other literal
+      if (w.clause < 0) {
+        *(j++) = w;
+        if (!S->falseMark[w.blocker]) {
+          setTrue(S, w.blocker, binaryReason(lit), forced);
+          continue;
+        }
+        conflict = S->DB - w.clause;
+        while (i < end)
+          *(j++) = *(i++);
+        break;
+      }
       // Get the clause from DB
-      int *clause = (S->DB + *watch + 1);
-      // Set the pointer to the first literal in the clause
-      if (clause[-2] == 0)
-        clause++;
+      int *clause = S->DB + w.clause;
       // Ensure that the other watched literal is in front
       if (clause[0] == lit)
         clause[0] = clause[1];
+      clause[1] = lit;
+      // If the other watched literal is satisfied, make it the blocker
+      w.blocker = clause[0];
+      if (S->falseMark[-clause[0]]) {
+        *(j++) = w;
+        continue;
+      }
       // Scan the non-watched literals
-      for (i = 2; unit && clause[i]; i++)
-        // When clause[i] is not false, it is either true or unset
-        if (!S->falseMark[clause[i]]) {
-          // Swap literals
-          clause[1] = clause[i];
-          clause[i] = lit;
-          // Store the old watch
-          int store = *watch;
+      int k, unit = 1;
+      for (k = 2; clause[k]; k++)
+        // When clause[k] is not false, it is either true or unset
+        if (!S->falseMark[clause[k]]) {
+          // Swap literals and move the watch to clause[1]
+          clause[1] = clause[k];
+          clause[k] = lit;
+          if (addWatch(S, clause[1], w.clause, clause[0]) != SAT) {
+            return MEMOUT;
+          }
           unit = 0;
-          // Remove the watch from the list of lit
-          *watch = S->DB[*watch];
-          // Add the watch to the list of clause[1]
-          addWatch(S, clause[1], store);
-        }
-      // If the clause is indeed unit
-      if (unit) {
-        // Place lit at clause[1] and update next watch
-        clause[1] = lit;
-        watch = (S->DB + *watch);
-        // If the other watched literal is satisfied continue
-        if (S->falseMark[-clause[0]])
-          continue;
-        // If the other watched literal is falsified,
-        if (!S->falseMark[clause[0]]) {
-          // A unit clause is found, and the reason is set
-          assign(S, clause, forced);
-        } else {
-          // Found a root level conflict -> UNSAT
-          if (forced)
-            return UNSAT;
-          // Analyze the conflict return a conflict clause
-          int *lemma = analyze(S, clause);
-          // In case a unit clause is found, set forced flag
-          if (!lemma[1])
-            forced = 1;
-          // Assign the conflict clause as a unit
-          assign(S, lemma, forced);
           break;
         }
+      if (!unit)
+        continue;
+      // The clause is indeed unit, keep the watch
+      *(j++) = w;
+      // If the other watched literal is falsified,
+      if (!S->falseMark[clause[0]]) {
+        // A unit clause is found, and the reason is set
+        assign(S, clause, forced);
+        continue;
       }
+      // Otherwise the clause is falsified, keep the other watches
+      conflict = clause;
+      while (i < end)
+        *(j++) = *(i++);
+    }
+    // Complete the list before a lemma adds watches to it
+    ws->size = (int)(j - ws->list);
+    if (conflict) {
+      // Found a root level conflict -> UNSAT
+      if (forced)
+        return UNSAT;
+      // Analyze the conflict return a conflict clause
+      int *lemma = analyze(S, conflict);
+      if (lemma == NULL)
+        return MEMOUT;
+      // In case a unit clause is found, set forced flag
+      if (!lemma[1])
+        forced = 1;
+      // Assign the conflict clause as a unit
+      assign(S, lemma, forced);
     }
   }
   // Set S->forced if applicable
@@ -338,50 +557,182 @@ int propagate(solver_t *S) {
   return SAT;
 }
 
-// Determine satisfiability
-int solve(solver_t *S) {
+// Pop the unassigned variable of highest activity, 0 if there is none
+static int popActive(solver_t *S) {
+  while (S->heap.size) {
+    int var;
+    rm_heap_pop(&S->heap, &var);
+    if (!S->falseMark[var] && !S->falseMark[-var])
+      return var;
+  }
+  return 0;
+}
+
+// The i-th element of the Luby sequence 1 1 2 1 1 2 4 1 1 2 ...
+static long long luby(long long i) {
+  for (;;) {
+    // The smallest k with i <= 2^k - 1
+    int k = 1;
+    while ((1LL << k) - 1 < i)
+      k++;
+    if (i == (1LL << k) - 1)
+      return 1LL << (k - 1);
+    // Otherwise the sequence repeats from its start
+    i -= (1LL << (k - 1)) - 1;
+  }
+}
+
+// Return whether to restart after a conflict, by the restart policy
+static int restarting(solver_t *S) {
+  // Stable mode restarts rarely
+  if (S->stable)
+    return S->res >= STABLE_INTERVAL * luby(S->nStable + 1);
+  if (S->opt.restarts != EMA) {
+    // S->res counts the conflicts since the last restart
+    if (S->res < S->interval)
+      return 0;
+    if (S->opt.restarts == LUBY)
+      S->interval = S->opt.interval * luby(S->nRestarts + 2);
+    else
+      S->interval = S->interval * S->opt.factor / 100;
+    return 1;
+  }
+  // If fast average is substantially larger than slow average
+  long long limit = (S->slow / 100) * (long long)S->opt.margin;
+  if (S->fast <= limit)
+    return 0;
+  // Update the averages
+  S->fast = (int)(limit < INT_MAX ? limit : INT_MAX);
+  // Keep a trail much larger than average, the search may be close to
+  // a solution
+  if (S->opt.block && S->nConflicts > BLOCK_AFTER &&
+      ((long long)S->lastTrail * 100 << TRAIL_WINDOW) >
+          S->trail * S->opt.block) {
+    S->nBlocked++;
+    return 0;
+  }
+  return 1;
+}
+
+// Use heuristic for the decisions, with all unforced literals
+// unassigned
+static void setHeuristic(solver_t *S, int heuristic) {
+  S->heuristic = heuristic;
+  // Search VMTF from the head, or put the unassigned variables in the
+  // heap of VSIDS
+  S->search = S->head;
+  if (heuristic == VSIDS) {
+    int n = 0;
+    for (int var = 1; var <= S->nVars; var++)
+      if (!S->falseMark[var] && !S->falseMark[-var])
+        S->buffer[n++] = var;
+    rm_heap_build(&S->heap, S->buffer, n, S->activity);
+  }
+}
+
+// Switch between focused and stable mode, after a restart
+static void switchMode(solver_t *S) {
+  double now = wallTime();
+  S->modeTime[S->stable] += now - S->modeStart;
+  S->modeStart = now;
+  S->stable = !S->stable;
+  S->nSwitches++;
+  setHeuristic(S, S->stable ? VSIDS : S->opt.heuristic);
+  S->modeLength *= 2;
+  S->nextSwitch = S->nConflicts + S->modeLength;
+}
+
+// Reset the saved phases of the unassigned variables, after a restart:
+// to the original ones, the inverted ones, and then alternately to the
+// best ones and the original or inverted ones
+static void rephase(solver_t *S) {
+  long long i = S->nRephased[ORIGINAL] + S->nRephased[INVERTED] +
+                S->nRephased[BEST];
+  int kind = i < 2 ? (int)i : i % 2 == 0 ? BEST : i % 4 == 3 ? ORIGINAL
+                                                              : INVERTED;
+  S->nRephased[kind]++;
+  for (int var = 1; var <= S->nVars; var++) {
+    if (S->falseMark[var] || S->falseMark[-var])
+      continue;
+    if (kind == BEST) {
+      if (S->best[var])
+        S->model[var] = S->best[var] > 0;
+    } else
+      S->model[var] = kind == INVERTED;
+    // The target phases start again from the saved ones
+    S->target[var] = 0;
+  }
+  S->targetAssigned = S->bestAssigned = 0;
+  S->nextRephase = S->nConflicts + S->opt.rephase * (i + 2);
+}
+
+// Determine satisfiability, from search
+static int search(solver_t *S) {
   // Initialize the solver
-  int decision = S->head;
+  int decision = 0;
   S->res = 0;
   // Main solve loop
   for (;;) {
     // Store nLemmas to see whether propagate adds lemmas
     int old_nLemmas = S->nLemmas;
     // Propagation returns UNSAT for a root level conflict
-    if (propagate(S) == UNSAT)
-      return UNSAT;
+    // and MEMOUT if the database cannot hold a new lemma
+    int res = propagate(S);
+    if (res != SAT)
+      return res;
+    if (S->opt.conflicts && S->nConflicts >= S->opt.conflicts)
+      return UNKNOWN;
 
     // If the last decision caused a conflict
     if (S->nLemmas > old_nLemmas) {
-      // Reset the decision heuristic to head
-      decision = S->head;
-      // If fast average is substantially larger than slow average
-      if (S->fast > (S->slow / 100) * 125) {
+      // Switching modes and rephasing happen at restarts
+      int switching = S->opt.modes && S->nConflicts >= S->nextSwitch;
+      int rephasing = S->opt.rephase && S->nConflicts >= S->nextRephase;
+      if (switching || rephasing || restarting(S)) {
         // printf("c restarting after %i conflicts (%i %i) %i\n", S->res,
         //   S->fast, S->slow, S->nLemmas > S->maxLemmas);
-        // Restart and update the averages
         S->res = 0;
-        S->fast = (S->slow / 100) * 125;
+        if (S->stable)
+          S->nStable++;
+        else
+          S->nRestarts++;
         restart(S);
+        if (switching)
+          switchMode(S);
+        if (rephasing)
+          rephase(S);
         // Reduce the DB when it contains too many lemmas
         if (S->nLemmas > S->maxLemmas)
           reduceDB(S, 6);
       }
     }
 
-    // As long as the temporay decision is assigned
-    while (S->falseMark[decision] || S->falseMark[-decision]) {
-      // Replace it with the next variable in the decision list
-      decision = S->prev[decision];
+    if (S->heuristic == VSIDS)
+      decision = popActive(S);
+    else {
+      // The variables after search in the list are assigned
+      decision = S->search;
+      // As long as the temporay decision is assigned
+      while (S->falseMark[decision] || S->falseMark[-decision]) {
+        // Replace it with the next variable in the decision list
+        decision = S->prev[decision];
+      }
+      // Continue from there, unless a newer variable gets unassigned
+      S->search = decision;
     }
     // If the end of the list is reached, then a solution is found
     if (decision == 0)
       return SAT;
-    // Otherwise, assign the decision variable based on the model
+    // Otherwise, assign the decision variable based on the model, or
+    // in stable mode on the target phase if known
+    if (S->stable && S->target[decision])
+      S->model[decision] = S->target[decision] > 0;
     decision = S->model[decision] ? decision : -decision;
     // Assign the decision literal to true (change to IMPLIED-1?)
     S->falseMark[-decision] = 1;
-    // And push it on the assigned stack
+    // And push it on the assigned stack, starting a new level
+    S->decisions[S->nDecisions++] = (int)(S->assigned - S->falseStack);
+    S->level[abs(decision)] = S->nDecisions;
     *(S->assigned++) = -decision;
     // Decisions have no reason clauses
     decision = abs(decision);
@@ -389,43 +740,152 @@ int solve(solver_t *S) {
   }
 }
 
-// n variables, m clauses
-void initCDCL(solver_t *S, int n, int m) {
+// Determine satisfiability
+int solve(solver_t *S) {
+  S->modeStart = wallTime();
+  int res = search(S);
+  // Add the time of the last mode
+  S->modeTime[S->stable] += wallTime() - S->modeStart;
+  return res;
+}
+
+// Set the options to their default values
+void defaultOptions(struct options *opt) {
+  opt->threads = 0;
+  opt->cache = 0;
+  opt->conflicts = 0;
+  opt->heuristic = VMTF;
+  opt->restarts = EMA;
+  opt->fast = 5;
+  opt->slow = 15;
+  opt->margin = 125;
+  opt->block = 0;
+  opt->interval = 100;
+  opt->factor = 150;
+  opt->modes = 1000;
+  opt->rephase = 1000;
+}
+
+// Allocate an array of n elements of the given size
+static void *getArray(size_t n, size_t size, int *ok) {
+  void *array = malloc(size * n);
+  if (array == NULL)
+    *ok = 0;
+  return array;
+}
+
+// n variables, m clauses, mem: the expected number of ints taken by
+// the clauses in the database (0 if unknown)
+// Return MEMOUT if the memory cannot be allocated
+int initCDCL(solver_t *S, int n, int m, long long mem) {
+  int ok = 1;
   // The code assumes that there is at least one variable
   if (n < 1)
     n = 1;
+  if (m < 0)
+    m = 0;
+  // Without a size estimate assume clauses of three literals
+  if (mem <= 0)
+    mem = 4 * (long long)m;
+  // Leave room for the first lemmas
+  mem += 1 << 16;
   // Set the number of variables
   S->nVars = n;
   // Set the number of clauses
   S->nClauses = m;
   // Set the initial maximum memory
-  S->mem_max = 1 << 30;
+  S->mem_max = (ref_t)(mem > MAX_CELLS ? MAX_CELLS : mem);
   // The number of integers allocated in the DB
   S->mem_used = 0;
   // The number of learned clauses -- redundant means learned
   S->nLemmas = 0;
   // Number of conflicts used to update scores
   S->nConflicts = 0;
+  // Number of propagated literals
+  S->nPropagations = 0;
   // Initial maximum number of learned clauses
   S->maxLemmas = 2000;
   // Initialize the fast and slow moving averages
   S->fast = S->slow = 1 << 24;
-  // Allocate the initial database
-  S->DB = (int *)malloc(sizeof(int) * S->mem_max);
+  // Restarts so far, and the conflicts before the first LUBY or
+  // GEOMETRIC restart
+  S->nRestarts = S->nBlocked = 0;
+  S->interval = S->opt.interval;
+  S->trail = S->lastTrail = 0;
+  // Start in focused mode, with the first switch and rephasing after
+  // the given conflicts
+  S->stable = 0;
+  S->modeLength = S->nextSwitch = S->opt.modes;
+  S->nextRephase = S->opt.rephase;
+  S->nSwitches = S->nStable = 0;
+  S->nRephased[ORIGINAL] = S->nRephased[INVERTED] = S->nRephased[BEST] = 0;
+  S->modeTime[0] = S->modeTime[1] = 0;
+  S->targetAssigned = S->bestAssigned = 0;
+  // Allocate the initial database, it grows in getMemory
+  S->DB = getArray(S->mem_max, sizeof(int), &ok);
   // Full assignment of the (Boolean) variables (initially set to false)
-  S->model = getMemory(S, n + 1);
+  S->model = getArray(n + 1, sizeof(int), &ok);
   // Next variable in the heuristic order
-  S->next = getMemory(S, n + 1);
+  S->next = getArray(n + 1, sizeof(int), &ok);
   // Previous variable in the heuristic order
-  S->prev = getMemory(S, n + 1);
+  S->prev = getArray(n + 1, sizeof(int), &ok);
+  // Enqueue time of each variable in the list, the head is the newest
+  S->stamp = getArray(n + 1, sizeof(long long), &ok);
   // A buffer to store a temporary clause
-  S->buffer = getMemory(S, n);
+  S->buffer = getArray(n + 1, sizeof(int), &ok);
   // Array of clauses
   // reason[lit] indicates the reason clause of the current assignment
-  // of lit. Its value is the offset of the clause from DB.
-  S->reason = getMemory(S, n + 1);
+  // of lit. Its value is 1 + the offset of the clause from DB, 0 for a
+  // decision, or negative for a binary clause (see binaryReason).
+  S->reason = getArray(n + 1, sizeof(ref_t), &ok);
   // Stack of falsified literals -- this pointer is never changed
-  S->falseStack = getMemory(S, n + 1);
+  S->falseStack = getArray(n + 1, sizeof(int), &ok);
+  // Decision level of each assigned variable
+  S->level = getArray(n + 1, sizeof(int), &ok);
+  // Positions of the decisions on falseStack, decisions[l] starts
+  // level l + 1
+  S->decisions = getArray(n + 1, sizeof(int), &ok);
+  // The current decision level
+  S->nDecisions = 0;
+  // The literals whose falseMark analyze has to reset
+  S->marked = getArray(n + 1, sizeof(int), &ok);
+  S->nMarked = 0;
+  // The stack of implied(), its depth is at most the number of variables
+  S->stack = getArray(n + 1, sizeof(struct frame), &ok);
+  // Literals of the lemmas before and removed by minimization
+  S->nLemmaLiterals = S->nMinimized = 0;
+  S->minimizeTime = 0;
+  // levelSeen[level] is the last conflict with a literal of level in
+  // its lemma, used to compute the LBD
+  S->levelSeen = calloc(n + 1, sizeof(int));
+  if (S->levelSeen == NULL)
+    ok = 0;
+  // Target and best phases, none known yet
+  S->target = calloc(n + 1, sizeof(int));
+  S->best = calloc(n + 1, sizeof(int));
+  if (S->target == NULL || S->best == NULL)
+    ok = 0;
+  // Activities for VSIDS, bumps add increment to them
+  S->activity = getArray(n + 1, sizeof(float), &ok);
+  S->increment = 1;
+  rm_heap_init_heap(&S->heap, n + 1);
+  if (S->heap.indices == NULL)
+    ok = 0;
+  // Labels for variables, non-zero means false
+  S->falseMark = getArray(2 * n + 1, sizeof(int), &ok);
+  // The watches of each literal, the lists grow in addWatch
+  S->watches = getArray(2 * n + 1, sizeof(watches_t), &ok);
+  if (S->falseMark)
+    S->falseMark += n;
+  if (S->watches) {
+    for (int i = 0; i <= 2 * n; i++)
+      S->watches[i] = (watches_t){NULL, 0, 0};
+    S->watches += n;
+  }
+  if (!ok) {
+    freeCDCL(S);
+    return MEMOUT;
+  }
   // Points inside *falseStack at first decision (unforced literal)
   S->forced = S->falseStack;
   // In the memory between 'processed' and 'assigned' resides
@@ -434,94 +894,67 @@ void initCDCL(solver_t *S, int n, int m) {
   S->processed = S->falseStack;
   // Points inside *falseStack at last unprocessed literal
   S->assigned = S->falseStack;
-  // Labels for variables, non-zero means false
-  S->falseMark = getMemory(S, 2 * n + 1);
-  S->falseMark += n;
-  // Offset of the first watched clause
-  S->first = getMemory(S, 2 * n + 1);
-  S->first += n;
   // Make sure there is a 0 before the clauses are loaded.
   S->DB[S->mem_used++] = 0;
+  // No irreducible clauses yet
+  S->mem_fixed = S->mem_used;
   // Initialize the main datastructures:
   for (int i = 1; i <= n; i++) {
     // the double-linked list for variable-move-to-front,
     S->prev[i] = i - 1;
     S->next[i - 1] = i;
-    // the model (phase-saving), the false array,
+    S->stamp[i] = i;
+    // and the model (phase-saving), the false array.
     S->model[i] = S->falseMark[-i] = S->falseMark[i] = 0;
-    // and first (watch pointers).
-    S->first[i] = S->first[-i] = END;
+    // and the activities for VSIDS.
+    S->activity[i] = 0;
   }
   // Initialize the head of the double-linked list
   S->head = n;
+  S->stamp[0] = 0;
+  S->nStamps = n;
+  // Start with the heuristic of focused mode
+  setHeuristic(S, S->opt.heuristic);
+  return SAT;
 }
 
-static void read_until_new_line(FILE *input) {
-  int ch;
-  while ((ch = getc(input)) != '\n')
-    if (ch == EOF) {
-      printf("parse error: unexpected EOF");
-      exit(1);
-    }
-}
-
-// Parse the formula and initialize
-int parse(solver_t *S, char *filename) {
-  int tmp;
-  // Read the CNF file
-  FILE *input = fopen(filename, "r");
-  while ((tmp = getc(input)) == 'c')
-    read_until_new_line(input);
-  ungetc(tmp, input);
-  do {
-    // Find the first non-comment line
-    tmp = fscanf(input, " p cnf %i %i \n", &S->nVars, &S->nClauses);
-    // In case a commment line was found
-    if (tmp > 0 && tmp != EOF)
-      break;
-    tmp = fscanf(input, "%*s\n");
-  }
-  // Skip it and read next line
-  while (tmp != 2 && tmp != EOF);
-  // Allocate the main datastructures
-  initCDCL(S, S->nVars, S->nClauses);
-  // Initialize the number of clauses to read
-  int nZeros = S->nClauses, size = 0;
-  // While there are clauses in the file
-  while (nZeros > 0) {
-    int ch = getc(input);
-    if (ch == ' ' || ch == '\n')
-      continue;
-    if (ch == 'c') {
-      read_until_new_line(input);
-      continue;
-    }
-    ungetc(ch, input);
-    int lit = 0;
-    // Read a literal.
-    tmp = fscanf(input, " %i ", &lit);
-    // If reaching the end of the clause
-    if (!lit) {
-      // Then add the clause to data_base
-      int *clause = addClause(S, S->buffer, size, 1);
-      // Check for empty clause or conflicting unit
-      if (!size || ((size == 1) && S->falseMark[clause[0]]))
-        // If either is found return UNSAT
-        return UNSAT;
-      // Check for a new unit
-      if ((size == 1) && !S->falseMark[-clause[0]]) {
-        // Directly assign new units (forced = 1)
-        assign(S, clause, 1);
-      }
-      // Reset buffer
-      size = 0;
-      --nZeros;
-    } else
-      // Add literal to buffer
-      S->buffer[size++] = lit;
+// Release the memory allocated by initCDCL
+void freeCDCL(solver_t *S) {
+  // falseMark and watches are offset by nVars
+  if (S->falseMark)
+    S->falseMark -= S->nVars;
+  if (S->watches) {
+    S->watches -= S->nVars;
+    for (int i = 0; i <= 2 * S->nVars; i++)
+      free(S->watches[i].list);
   }
-  // Close the formula file
-  fclose(input);
-  // Return that no conflict was observed
-  return SAT;
+  free(S->DB);
+  free(S->model);
+  free(S->next);
+  free(S->prev);
+  free(S->stamp);
+  free(S->buffer);
+  free(S->reason);
+  free(S->falseStack);
+  free(S->level);
+  free(S->decisions);
+  free(S->marked);
+  free(S->stack);
+  free(S->levelSeen);
+  free(S->target);
+  free(S->best);
+  free(S->activity);
+  rm_heap_destroy_heap(&S->heap);
+  free(S->falseMark);
+  free(S->watches);
+  S->DB = NULL;
+  S->reason = NULL;
+  S->watches = NULL;
+  S->model = S->next = S->prev = S->buffer = NULL;
+  S->falseStack = S->falseMark = NULL;
+  S->level = S->decisions = S->marked = S->levelSeen = NULL;
+  S->stack = NULL;
+  S->stamp = NULL;
+  S->target = S->best = NULL;
+  S->activity = NULL;
 }
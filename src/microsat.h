@@ -28,22 +28,144 @@
 #ifndef MICROSAT
 #define MICROSAT
 
+#include <limits.h>
+
+#include "rm_heap.h"
+
+// Offsets of clauses in the database. Building with make OFFSETS=64
+// lifts the limit of 2^31 ints in the database, at the cost of larger
+// watches and reasons.
+#ifdef LONG_OFFSETS
+typedef long long ref_t;
+#define REF_MAX LLONG_MAX
+#else
+typedef int ref_t;
+#define REF_MAX INT_MAX
+#endif
+
 // If a variable is marked as IMPLIED in falseMark, then it is
 // a force assignment.
-// END marks the end of a linked list
-enum { END = -9, UNSAT = 0, SAT = 1, MARK = 2, IMPLIED = 6 };
+// MEMOUT is returned if the clause database cannot grow, UNKNOWN if
+// the conflict limit is reached
+enum { UNSAT = 0, SAT = 1, MARK = 2, MEMOUT = 3, UNKNOWN = 4, IMPLIED = 6 };
+
+// Decision heuristics: the move-to-front list of variables bumped in
+// conflicts, or the variable of highest activity in a heap (EVSIDS)
+enum { VMTF = 0, VSIDS = 1 };
+
+// Restart policies: when the recent LBDs of the lemmas get worse than
+// their long term average (EMA), or after a number of conflicts from
+// the Luby sequence or a geometric progression
+enum { EMA = 0, LUBY = 1, GEOMETRIC = 2 };
+
+// Rephasing resets the saved phases to the original (false) ones, their
+// inverse, or the best ones
+enum { ORIGINAL = 0, INVERTED = 1, BEST = 2 };
+
+// A watch of a clause: its offset in the database, and another literal
+// of the clause. If the blocker is true, the clause is satisfied and
+// propagation can skip it without reading the clause. Binary clauses
+// have a negative offset, and their blocker is the other literal, so
+// propagation never reads them.
+typedef struct {
+  ref_t clause;
+  int blocker;
+} watch_t;
+
+// The watches of a literal
+typedef struct {
+  watch_t *list;
+  int size, capacity;
+} watches_t;
+
+// User settings, filled by defaultOptions() before parse()
+struct options {
+  // Number of threads used to parse the input (0 = one per core)
+  int threads;
+  // Load text files through a binary copy stored next to them
+  int cache;
+  // Stop after this number of conflicts (0 = no limit)
+  int conflicts;
+  // The decision heuristic, VMTF or VSIDS
+  int heuristic;
+  // The restart policy, EMA, LUBY or GEOMETRIC
+  int restarts;
+  // EMA restarts when the average LBD over the last 2^fast conflicts
+  // exceeds the one over the last 2^slow conflicts by margin percent,
+  // unless the trail is block percent of its average (0 = no blocking)
+  int fast, slow, margin, block;
+  // The first interval of LUBY and GEOMETRIC in conflicts, and the
+  // factor of GEOMETRIC in percent
+  int interval, factor;
+  // Switch between focused and stable mode after modes conflicts,
+  // doubling after each switch (0 = focused mode only)
+  int modes;
+  // Rephase after rephase * i conflicts for the i-th time (0 = never)
+  int rephase;
+};
 
 // The variables in the struct are described in the initCDCL procedure
 struct solver {
-  int *DB, nVars, nClauses, mem_used, mem_fixed, mem_max, maxLemmas, nLemmas,
-      *buffer, nConflicts, *model, *reason, *falseStack, *falseMark, *first,
-      *forced, *processed, *assigned, *next, *prev, head, res, fast, slow;
+  int *DB;
+  ref_t mem_used, mem_fixed, mem_max, *reason;
+  watches_t *watches;
+  long long nPropagations, nLemmaLiterals, nMinimized;
+  int nVars, nClauses, maxLemmas, nLemmas, *buffer, nConflicts, *model,
+      *falseStack, *falseMark, *forced, *processed, *assigned, *next, *prev,
+      head, res, fast, slow, *level, *decisions, nDecisions, *marked,
+      nMarked, *levelSeen;
+  // Clauses and literals removed by the normalization at load time
+  // (the state of the normalization is kept in loader)
+  long long removedClauses, removedLiterals;
+  struct loader *loader;
+  struct frame *stack;
+  // The enqueue times of the variables in the VMTF list, and the
+  // variable from which the search for a decision starts
+  long long *stamp, nStamps;
+  int search;
+  // The average trail size at conflicts (times 2^TRAIL_WINDOW) and the
+  // size at the last one, the restarts and blocked restarts, and the
+  // next LUBY or GEOMETRIC interval
+  long long trail, nRestarts, nBlocked, interval;
+  int lastTrail;
+  // The decision heuristic of the current mode, and whether it is the
+  // stable mode
+  int heuristic, stable;
+  // The phases (1 true, -1 false, 0 unknown) of the longest conflict-free
+  // trails since the last restart (target) and rephasing (best), and
+  // the sizes of those trails
+  int *target, *best, targetAssigned, bestAssigned;
+  // The conflicts at the next mode switch and rephasing, the length of
+  // the current mode, the switches and restarts in stable mode, and
+  // the rephasings of each kind
+  long long nextSwitch, modeLength, nextRephase, nSwitches, nStable,
+      nRephased[3];
+  // The time spent in focused and stable mode, and when the current
+  // mode started
+  double modeTime[2], modeStart;
+  // The activities of the variables, and the unassigned variables
+  // ordered by activity for VSIDS
+  float *activity, increment;
+  rm_heap_t heap;
+  double parseTime, decompressTime, minimizeTime;
+  struct options opt;
 };
 
 typedef struct solver solver_t;
 
+void defaultOptions(struct options *);
+
 int solve(solver_t *);
 
 int parse(solver_t *, char *);
 
+// Interface used by the DIMACS front ends in dimacs.c
+int initCDCL(solver_t *, int, int, long long);
+
+void freeCDCL(solver_t *);
+
+int *addClause(solver_t *, int *, int, int);
+
+void assign(solver_t *, int *, int);
+
 #endif
@@ -0,0 +1,248 @@
+/* 
+ * Copyright (c) 2022 Guangchen Li (guangchenli96@gmail.com)
+ * 
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+
+// This is the d-ary heap, whichever variant the build selects
+#ifndef DARY_HEAP
+#define DARY_HEAP
+#endif
+#include "rm_heap.h"
+
+#define ARITY RM_HEAP_ARITY
+// Size of a cache line
+#define LINE 64
+
+// The nodes are moved into a hole instead of being swapped, so every
+// level of swim/dive writes one node and one index
+
+void rm_heap_init_heap(rm_heap_t* H, size_t s) {
+  H->indices = (int*)malloc(s * sizeof(int));
+  // Room to align the children of the root, and the padding after
+  // the last node
+  H->block = malloc((s + ARITY) * sizeof(struct rm_node) + LINE);
+  H->pending_lits = (int*)malloc(s * sizeof(int));
+  H->pending_vals = (float*)malloc(s * sizeof(float));
+  H->nodes = NULL;
+  H->size = 0;
+  H->max_size = s;
+  H->n_pending = 0;
+  // On failure all arrays are NULL
+  if (H->indices == NULL || H->block == NULL || H->pending_lits == NULL ||
+      H->pending_vals == NULL) {
+    rm_heap_destroy_heap(H);
+    H->max_size = 0;
+    return;
+  }
+  // Align nodes such that nodes[ARITY * i + 1] starts a cache line (or
+  // half a line for ARITY 4)
+  uintptr_t base = ((uintptr_t)H->block + LINE - 1) & ~(uintptr_t)(LINE - 1);
+  H->nodes = (struct rm_node*)base + ARITY - 1;
+  for (size_t i = 0; i < s; i++)
+    H->indices[i] = -1;
+}
+
+
+void rm_heap_destroy_heap(rm_heap_t* H) {
+  free(H->indices);
+  free(H->block);
+  free(H->pending_lits);
+  free(H->pending_vals);
+  H->indices = NULL;
+  H->block = NULL;
+  H->nodes = NULL;
+  H->pending_lits = NULL;
+  H->pending_vals = NULL;
+}
+
+
+bool rm_heap_in_heap(rm_heap_t* H, int lit) {
+  assert(lit < H->max_size);
+  return H->indices[lit] >= 0;
+}
+
+
+// Move the node at offset up to its place
+static void swim(rm_heap_t* H, size_t offset) {
+  struct rm_node node = H->nodes[offset];
+  while (offset > 0) {
+    size_t parent = (offset - 1) / ARITY;
+    if (!(H->nodes[parent].val < node.val))
+      break;
+    H->nodes[offset] = H->nodes[parent];
+    H->indices[H->nodes[offset].lit] = offset;
+    offset = parent;
+  }
+  H->nodes[offset] = node;
+  H->indices[node.lit] = offset;
+}
+
+
+// Move the node at offset down to its place
+static void dive(rm_heap_t* H, size_t offset) {
+  struct rm_node node = H->nodes[offset];
+  for (;;) {
+    size_t first = ARITY * offset + 1, last = first + ARITY;
+    if (first >= H->size)
+      break;
+    if (last > H->size)
+      last = H->size;
+    // The largest child, all children are in one cache line
+    size_t max = first;
+    for (size_t child = first + 1; child < last; child++)
+      if (H->nodes[child].val > H->nodes[max].val)
+        max = child;
+    if (!(H->nodes[max].val > node.val))
+      break;
+    H->nodes[offset] = H->nodes[max];
+    H->indices[H->nodes[offset].lit] = offset;
+    offset = max;
+  }
+  H->nodes[offset] = node;
+  H->indices[node.lit] = offset;
+}
+
+
+void rm_heap_decrease(rm_heap_t* H, int lit, float new_val) {
+  assert(lit < H->max_size && H->indices[lit] >= 0);
+  size_t offset = H->indices[lit];
+  H->nodes[offset].val = new_val;
+  dive(H, offset);
+}
+
+
+void rm_heap_increase(rm_heap_t* H, int lit, float new_val) {
+  assert(lit < H->max_size && H->indices[lit] >= 0);
+  size_t offset = H->indices[lit];
+  H->nodes[offset].val = new_val;
+  swim(H, offset);
+}
+
+
+void rm_heap_update(rm_heap_t* H, int lit, float new_val) {
+  assert(lit < H->max_size && H->indices[lit] >= 0);
+  float old_val = H->nodes[H->indices[lit]].val;
+  if (new_val > old_val) {
+    rm_heap_increase(H, lit, new_val);
+  } else if (new_val < old_val) {
+    rm_heap_decrease(H, lit, new_val);
+  }
+}
+
+
+void rm_heap_push(rm_heap_t* H, int lit, float val) {
+  assert(H->size < H->max_size && lit < H->max_size);
+  H->nodes[H->size] = (struct rm_node){val, lit};
+  H->size++;
+  swim(H, H->size - 1);
+}
+
+
+float rm_heap_pop(rm_heap_t* H, int* lit) {
+  assert(H->size > 0);
+  float result = H->nodes[0].val;
+  *lit = H->nodes[0].lit;
+  H->indices[*lit] = -1;
+  // Move the last node to the root and let it dive
+  if (--H->size > 0) {
+    H->nodes[0] = H->nodes[H->size];
+    dive(H, 0);
+  }
+  return result;
+}
+
+
+float rm_heap_peek(rm_heap_t* H, int* lit) {
+  assert(H->size > 0);
+  *lit = H->nodes[0].lit;
+  return H->nodes[0].val;
+}
+
+
+// Only the indices of the literals in the heap are reset, all at once
+// when the heap is large
+void rm_heap_clear(rm_heap_t* H) {
+  if (H->size > H->max_size / 8)
+    memset(H->indices, 0xff, H->max_size * sizeof(int));
+  else
+    for (size_t i = 0; i < H->size; i++)
+      H->indices[H->nodes[i].lit] = -1;
+  H->size = 0;
+  H->n_pending = 0;
+}
+
+
+// Let all nodes with children dive, bottom up (Floyd)
+static void heapify(rm_heap_t* H) {
+  if (H->size < 2)
+    return;
+  for (size_t offset = (H->size - 2) / ARITY + 1; offset-- > 0;)
+    dive(H, offset);
+}
+
+
+void rm_heap_build(rm_heap_t* H, const int* lits, size_t n,
+                   const float* vals) {
+  assert(n <= H->max_size);
+  rm_heap_clear(H);
+  for (size_t i = 0; i < n; i++) {
+    H->nodes[i] = (struct rm_node){vals[lits[i]], lits[i]};
+    H->indices[lits[i]] = i;
+  }
+  H->size = n;
+  heapify(H);
+}
+
+
+void rm_heap_batch_set(rm_heap_t* H, int lit, float new_val) {
+  assert(lit < H->max_size);
+  if (H->n_pending == H->max_size)
+    rm_heap_batch_end(H);
+  H->pending_lits[H->n_pending] = lit;
+  H->pending_vals[H->n_pending] = new_val;
+  H->n_pending++;
+}
+
+
+void rm_heap_batch_end(rm_heap_t* H) {
+  size_t n = H->n_pending, depth = 1;
+  H->n_pending = 0;
+  for (size_t s = H->size; s > 1; s /= ARITY)
+    depth++;
+  if (n * depth <= H->size) {
+    // Few values: O(log size) each
+    for (size_t i = 0; i < n; i++)
+      if (rm_heap_in_heap(H, H->pending_lits[i]))
+        rm_heap_update(H, H->pending_lits[i], H->pending_vals[i]);
+    return;
+  }
+  // Many values: set them all and rebuild the heap
+  for (size_t i = 0; i < n; i++)
+    if (rm_heap_in_heap(H, H->pending_lits[i]))
+      H->nodes[H->indices[H->pending_lits[i]]].val = H->pending_vals[i];
+  heapify(H);
+}
+
+
+void rm_heap_scale(rm_heap_t* H, float factor) {
+  for (size_t i = 0; i < H->size; i++)
+    H->nodes[i].val *= factor;
+  for (size_t i = 0; i < H->n_pending; i++)
+    H->pending_vals[i] *= factor;
+}
@@ -20,15 +20,28 @@
 
 #include <stdlib.h>
 #include <assert.h>
+#include <string.h>
 
+// This is the binary heap, whichever variant the build selects
+#undef DARY_HEAP
 #include "rm_heap.h"
 
 void rm_heap_init_heap(rm_heap_t* H, size_t s){
   H->indices = (int*)malloc(s * sizeof(int));
   H->lits = (int*)malloc(s * sizeof(int));
   H->heap = (float*)malloc(s * sizeof(float));
+  H->pending_lits = (int*)malloc(s * sizeof(int));
+  H->pending_vals = (float*)malloc(s * sizeof(float));
   H->size = 0;
   H->max_size = s;
+  H->n_pending = 0;
+  // On failure all arrays are NULL
+  if (H->indices == NULL || H->lits == NULL || H->heap == NULL ||
+      H->pending_lits == NULL || H->pending_vals == NULL) {
+    rm_heap_destroy_heap(H);
+    H->max_size = 0;
+    return;
+  }
   // Initialize indices
   for (int i = 0; i < s; i++) {
     H->indices[i] = -1;
@@ -41,9 +54,13 @@ void rm_heap_destroy_heap(rm_heap_t* H) {
   free(H->indices);
   free(H->lits);
   free(H->heap);
+  free(H->pending_lits);
+  free(H->pending_vals);
   H->indices = NULL;
   H->lits = NULL;
   H->heap = NULL;
+  H->pending_lits = NULL;
+  H->pending_vals = NULL;
 }
 
 
@@ -141,7 +158,7 @@ size_t rm_heap_dive(rm_heap_t* H, size_t offset) {
 
 
 void rm_heap_decrease(rm_heap_t* H, int lit, float new_val) {
-  assert(lit < H->size);
+  assert(lit < H->max_size);
   size_t heap_offset = H->indices[lit];
   H->heap[heap_offset] = new_val;
   size_t new_offset = rm_heap_dive(H, heap_offset);
@@ -149,7 +166,7 @@ void rm_heap_decrease(rm_heap_t* H, int lit, float new_val) {
 
 
 void rm_heap_increase(rm_heap_t* H, int lit, float new_val) {
-  assert(lit < H->size);
+  assert(lit < H->max_size);
   size_t heap_offset = H->indices[lit];
   H->heap[heap_offset] = new_val;
   size_t new_offset = rm_heap_swim(H, heap_offset);
@@ -157,7 +174,7 @@ void rm_heap_increase(rm_heap_t* H, int lit, float new_val) {
 
 
 void rm_heap_update(rm_heap_t* H, int lit, float new_val) {
-  assert(lit < H->size);
+  assert(lit < H->max_size);
   size_t heap_offset = H->indices[lit];
   float old_val = H->heap[heap_offset];
   if (new_val > old_val) {
@@ -169,7 +186,7 @@ void rm_heap_update(rm_heap_t* H, int lit, float new_val) {
 
 
 void rm_heap_push(rm_heap_t* H, int lit, float val) {
-  assert(H->size <= H->max_size);
+  assert(H->size < H->max_size);
   // Put the value at the end of the heap
   H->heap[H->size] = val;
   H->indices[lit] = H->size;
@@ -204,7 +221,76 @@ float rm_heap_peek(rm_heap_t* H, int* lit){
 }
 
 
+// Only the indices of the literals in the heap are reset, all at once
+// when the heap is large
 void rm_heap_clear(rm_heap_t* H) {
-  rm_heap_destroy_heap(H);
-  rm_heap_init_heap(H, H->size);
+  if (H->size > H->max_size / 8)
+    memset(H->indices, 0xff, H->max_size * sizeof(int));
+  else
+    for (size_t i = 0; i < H->size; i++)
+      H->indices[H->lits[i]] = -1;
+  H->size = 0;
+  H->n_pending = 0;
+}
+
+
+// Let all nodes with children dive, bottom up (Floyd)
+static void rm_heap_heapify(rm_heap_t* H) {
+  if (H->size == 0)
+    return;
+  for (size_t offset = H->size / 2 + 1; offset-- > 0;)
+    if (offset < H->size)
+      rm_heap_dive(H, offset);
+}
+
+
+void rm_heap_build(rm_heap_t* H, const int* lits, size_t n,
+                   const float* vals) {
+  assert(n <= H->max_size);
+  rm_heap_clear(H);
+  for (size_t i = 0; i < n; i++) {
+    H->heap[i] = vals[lits[i]];
+    H->lits[i] = lits[i];
+    H->indices[lits[i]] = i;
+  }
+  H->size = n;
+  rm_heap_heapify(H);
+}
+
+
+void rm_heap_batch_set(rm_heap_t* H, int lit, float new_val) {
+  assert(lit < H->max_size);
+  if (H->n_pending == H->max_size)
+    rm_heap_batch_end(H);
+  H->pending_lits[H->n_pending] = lit;
+  H->pending_vals[H->n_pending] = new_val;
+  H->n_pending++;
+}
+
+
+void rm_heap_batch_end(rm_heap_t* H) {
+  size_t n = H->n_pending, depth = 1;
+  H->n_pending = 0;
+  for (size_t s = H->size; s > 1; s /= 2)
+    depth++;
+  if (n * depth <= H->size) {
+    // Few values: O(log size) each
+    for (size_t i = 0; i < n; i++)
+      if (rm_heap_in_heap(H, H->pending_lits[i]))
+        rm_heap_update(H, H->pending_lits[i], H->pending_vals[i]);
+    return;
+  }
+  // Many values: set them all and rebuild the heap
+  for (size_t i = 0; i < n; i++)
+    if (rm_heap_in_heap(H, H->pending_lits[i]))
+      H->heap[H->indices[H->pending_lits[i]]] = H->pending_vals[i];
+  rm_heap_heapify(H);
+}
+
+
+void rm_heap_scale(rm_heap_t* H, float factor) {
+  for (size_t i = 0; i < H->size; i++)
+    H->heap[i] *= factor;
+  for (size_t i = 0; i < H->n_pending; i++)
+    H->pending_vals[i] *= factor;
 }
@@ -16,6 +16,11 @@
 
 /* A non-generic datastructure for implementing a priority queue that
  * supports random variable modification by their indices.
+ *
+ * rm_heap.c implements it as a binary heap. Building with DARY_HEAP
+ * defined (make HEAP=dary) selects rm_dheap.c instead, a d-ary heap
+ * whose nodes keep the value and the literal together, with the
+ * children of a node in one cache line.
  */
 
 #ifndef RM_HEAP
@@ -24,6 +29,8 @@
 #include <stddef.h>
 #include <stdbool.h>
 
+#ifndef DARY_HEAP
+
 struct rm_heap {
   // indices[lit] is the offset of literal 'lit' is in heap
   // Zero means the lit is not in heap.
@@ -36,8 +43,46 @@ struct rm_heap {
   size_t size;
   // Max size of the heap
   size_t max_size;
+  // Values set by rm_heap_batch_set, applied by rm_heap_batch_end
+  int* pending_lits;
+  float* pending_vals;
+  size_t n_pending;
 };
 
+#else
+
+// Children per node of the d-ary heap, RM_HEAP_ARITY nodes fill a
+// cache line
+#ifndef RM_HEAP_ARITY
+#define RM_HEAP_ARITY 8
+#endif
+
+struct rm_node {
+  float val;
+  int lit;
+};
+
+struct rm_heap {
+  // indices[lit] is the offset of literal 'lit' in nodes,
+  // -1 means the lit is not in heap.
+  int* indices;
+  // The heap, the children of nodes[i] are nodes[RM_HEAP_ARITY * i + 1]
+  // to nodes[RM_HEAP_ARITY * i + RM_HEAP_ARITY]
+  struct rm_node* nodes;
+  // The allocation holding nodes, which is aligned inside it
+  void* block;
+  // Current size of the heap
+  size_t size;
+  // Max size of the heap
+  size_t max_size;
+  // Values set by rm_heap_batch_set, applied by rm_heap_batch_end
+  int* pending_lits;
+  float* pending_vals;
+  size_t n_pending;
+};
+
+#endif
+
 typedef struct rm_heap rm_heap_t;
 
 void rm_heap_init_heap(rm_heap_t* H, size_t s);
@@ -66,7 +111,24 @@ float rm_heap_pop(rm_heap_t* H, int* lit);
 // Peek the largest value
 float rm_heap_peek(rm_heap_t* H, int* lit);
 
-// Clear all values in the heap
+// Clear all values in the heap, in place
 void rm_heap_clear(rm_heap_t* H);
 
+// Replace the heap by the n literals in lits, with values vals[lit],
+// in O(n)
+void rm_heap_build(rm_heap_t* H, const int* lits, size_t n,
+                   const float* vals);
+
+// Set the value of a literal later, at the next rm_heap_batch_end,
+// if it is in the heap then
+void rm_heap_batch_set(rm_heap_t* H, int lit, float new_val);
+
+// Apply the values set since the last call, one by one when there
+// are few of them, otherwise all at once in O(size)
+void rm_heap_batch_end(rm_heap_t* H);
+
+// Multiply all values in the heap (and pending values) by a positive
+// factor
+void rm_heap_scale(rm_heap_t* H, float factor);
+
 #endif
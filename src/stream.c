@@ -0,0 +1,393 @@
+/**************************************************************[stream.c]*****
+
+  The MIT License
+
+  Copyright (c) 2022 Guangchen Li
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+
+*******************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "stream.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_LZMA
+#include <lzma.h>
+#endif
+#ifdef HAVE_BZIP2
+#include <bzlib.h>
+#endif
+
+// The ring holds BLOCKS decoded blocks of BLOCK_SIZE bytes
+#define BLOCKS 8
+#define BLOCK_SIZE (1 << 20)
+// Compressed input is read in pieces of IN_SIZE bytes
+#define IN_SIZE (1 << 16)
+
+struct stream {
+  int fd, format;
+  // Decoded blocks; blocks are filled and consumed round robin
+  char *blocks[BLOCKS];
+  size_t length[BLOCKS];
+  // Number of blocks filled by the producer and released by the consumer
+  size_t produced, consumed;
+  // Set if the consumer is reading block consumed % BLOCKS
+  int holding;
+  // Set by the producer when it is finished, and by closeStream
+  int ended, stop;
+  pthread_mutex_t lock;
+  pthread_cond_t filled, freed;
+  pthread_t thread;
+  // Producer state: compressed input, end of input, end of the
+  // decoded data and the first error
+  unsigned char in[IN_SIZE];
+  size_t inLength;
+  int inputEnd, done;
+  const char *error;
+  size_t (*decode)(stream_t *, char *, size_t);
+#ifdef HAVE_ZLIB
+  z_stream z;
+#endif
+#ifdef HAVE_LZMA
+  lzma_stream x;
+#endif
+#ifdef HAVE_BZIP2
+  bz_stream b;
+#endif
+  double decompressTime, waitTime;
+};
+
+double wallTime() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int compressionFormat(const unsigned char *magic, size_t size) {
+  if (size >= 2 && magic[0] == 0x1f && magic[1] == 0x8b)
+    return GZIP;
+  if (size >= 6 && !memcmp(magic, "\xfd" "7zXZ\0", 6))
+    return XZ;
+  if (size >= 3 && !memcmp(magic, "BZh", 3))
+    return BZIP2;
+  return PLAIN;
+}
+
+// Read up to size bytes from the input, return 0 at the end of the file
+static size_t readInput(stream_t *St, void *buffer, size_t size) {
+  ssize_t n;
+  do
+    n = read(St->fd, buffer, size);
+  while (n < 0 && errno == EINTR);
+  if (n < 0) {
+    St->error = "cannot read input";
+    return 0;
+  }
+  return n;
+}
+
+// Refill the compressed input once it is consumed
+static size_t nextInput(stream_t *St) {
+  St->inLength = St->inputEnd ? 0 : readInput(St, St->in, IN_SIZE);
+  if (!St->inLength)
+    St->inputEnd = 1;
+  return St->inLength;
+}
+
+// Each decoder fills out with up to size bytes and only returns fewer
+// bytes at the end of the data or after an error
+
+static size_t decodePlain(stream_t *St, char *out, size_t size) {
+  size_t n = 0;
+  // First hand out the bytes read to detect the format
+  if (St->inLength) {
+    memcpy(out, St->in, St->inLength);
+    n = St->inLength;
+    St->inLength = 0;
+  }
+  while (n < size) {
+    size_t read = readInput(St, out + n, size - n);
+    if (!read) {
+      St->done = 1;
+      break;
+    }
+    n += read;
+  }
+  return n;
+}
+
+#ifdef HAVE_ZLIB
+static size_t decodeGzip(stream_t *St, char *out, size_t size) {
+  z_stream *z = &St->z;
+  z->next_out = (Bytef *)out;
+  z->avail_out = size;
+  while (z->avail_out && !St->done && !St->error) {
+    if (!z->avail_in) {
+      z->next_in = St->in;
+      if (!(z->avail_in = nextInput(St))) {
+        if (!St->error)
+          St->error = "unexpected end of gzip input";
+        break;
+      }
+    }
+    int ret = inflate(z, Z_NO_FLUSH);
+    if (ret == Z_STREAM_END) {
+      // Concatenated gzip members continue the data
+      if (!z->avail_in) {
+        z->next_in = St->in;
+        z->avail_in = nextInput(St);
+      }
+      if (z->avail_in)
+        inflateReset(z);
+      else
+        St->done = 1;
+    } else if (ret != Z_OK && ret != Z_BUF_ERROR)
+      St->error = "corrupt gzip input";
+  }
+  return size - z->avail_out;
+}
+#endif
+
+#ifdef HAVE_LZMA
+static size_t decodeXz(stream_t *St, char *out, size_t size) {
+  lzma_stream *x = &St->x;
+  x->next_out = (uint8_t *)out;
+  x->avail_out = size;
+  while (x->avail_out && !St->done && !St->error) {
+    if (!x->avail_in && !St->inputEnd) {
+      x->next_in = St->in;
+      x->avail_in = nextInput(St);
+      if (St->error)
+        break;
+    }
+    // Concatenated streams are handled by the decoder
+    lzma_ret ret = lzma_code(x, St->inputEnd ? LZMA_FINISH : LZMA_RUN);
+    if (ret == LZMA_STREAM_END)
+      St->done = 1;
+    else if (ret != LZMA_OK)
+      St->error = "corrupt xz input";
+  }
+  return size - x->avail_out;
+}
+#endif
+
+#ifdef HAVE_BZIP2
+static size_t decodeBzip2(stream_t *St, char *out, size_t size) {
+  bz_stream *b = &St->b;
+  b->next_out = out;
+  b->avail_out = size;
+  while (b->avail_out && !St->done && !St->error) {
+    if (!b->avail_in) {
+      b->next_in = (char *)St->in;
+      if (!(b->avail_in = nextInput(St))) {
+        if (!St->error)
+          St->error = "unexpected end of bzip2 input";
+        break;
+      }
+    }
+    int ret = BZ2_bzDecompress(b);
+    if (ret == BZ_STREAM_END) {
+      // Concatenated bzip2 streams continue the data
+      if (!b->avail_in) {
+        b->next_in = (char *)St->in;
+        b->avail_in = nextInput(St);
+      }
+      if (b->avail_in) {
+        char *next_in = b->next_in;
+        unsigned int avail_in = b->avail_in;
+        BZ2_bzDecompressEnd(b);
+        BZ2_bzDecompressInit(b, 0, 0);
+        b->next_in = next_in;
+        b->avail_in = avail_in;
+      } else
+        St->done = 1;
+    } else if (ret != BZ_OK)
+      St->error = "corrupt bzip2 input";
+  }
+  return size - b->avail_out;
+}
+#endif
+
+// The producer thread fills free blocks until the data ends
+static void *produce(void *arg) {
+  stream_t *St = arg;
+  for (;;) {
+    pthread_mutex_lock(&St->lock);
+    // Wait until the consumer has released a block
+    while (St->produced - St->consumed == BLOCKS && !St->stop)
+      pthread_cond_wait(&St->freed, &St->lock);
+    int stop = St->stop;
+    pthread_mutex_unlock(&St->lock);
+    if (stop)
+      break;
+    size_t slot = St->produced % BLOCKS;
+    double start = wallTime();
+    size_t n = St->decode(St, St->blocks[slot], BLOCK_SIZE);
+    St->decompressTime += wallTime() - start;
+    int ended = St->done || St->error;
+    pthread_mutex_lock(&St->lock);
+    if (n) {
+      St->length[slot] = n;
+      St->produced++;
+    }
+    St->ended = ended;
+    pthread_cond_signal(&St->filled);
+    pthread_mutex_unlock(&St->lock);
+    if (ended)
+      break;
+  }
+  return NULL;
+}
+
+static void openError(const char *format) {
+  printf("c %s input is not supported by this build\n", format);
+  exit(1);
+}
+
+stream_t *openStream(int fd) {
+  stream_t *St = calloc(1, sizeof(stream_t));
+  if (St == NULL) {
+    printf("c out of memory\n");
+    exit(1);
+  }
+  St->fd = fd;
+  for (int i = 0; i < BLOCKS; i++)
+    if ((St->blocks[i] = malloc(BLOCK_SIZE)) == NULL) {
+      printf("c out of memory\n");
+      exit(1);
+    }
+  // Read enough bytes to recognize the format
+  size_t n;
+  while (St->inLength < 6 &&
+         (n = readInput(St, St->in + St->inLength, IN_SIZE - St->inLength)))
+    St->inLength += n;
+  St->format = compressionFormat(St->in, St->inLength);
+  St->decode = decodePlain;
+  if (St->format == GZIP) {
+#ifdef HAVE_ZLIB
+    St->z.next_in = St->in;
+    St->z.avail_in = St->inLength;
+    // Accept a gzip header (16) with the maximum window size (15)
+    inflateInit2(&St->z, 16 + 15);
+    St->decode = decodeGzip;
+#else
+    openError("gzip");
+#endif
+  } else if (St->format == XZ) {
+#ifdef HAVE_LZMA
+    St->x = (lzma_stream)LZMA_STREAM_INIT;
+    if (lzma_stream_decoder(&St->x, UINT64_MAX, LZMA_CONCATENATED) !=
+        LZMA_OK) {
+      printf("c cannot initialize the xz decoder\n");
+      exit(1);
+    }
+    St->x.next_in = St->in;
+    St->x.avail_in = St->inLength;
+    St->decode = decodeXz;
+#else
+    openError("xz");
+#endif
+  } else if (St->format == BZIP2) {
+#ifdef HAVE_BZIP2
+    BZ2_bzDecompressInit(&St->b, 0, 0);
+    St->b.next_in = (char *)St->in;
+    St->b.avail_in = St->inLength;
+    St->decode = decodeBzip2;
+#else
+    openError("bzip2");
+#endif
+  }
+  pthread_mutex_init(&St->lock, NULL);
+  pthread_cond_init(&St->filled, NULL);
+  pthread_cond_init(&St->freed, NULL);
+  if (pthread_create(&St->thread, NULL, produce, St)) {
+    printf("c cannot create thread\n");
+    exit(1);
+  }
+  return St;
+}
+
+int nextBlock(stream_t *St, const char **begin, const char **end) {
+  pthread_mutex_lock(&St->lock);
+  // Hand the current block back to the producer
+  if (St->holding) {
+    St->consumed++;
+    St->holding = 0;
+    pthread_cond_signal(&St->freed);
+  }
+  double start = wallTime();
+  while (St->consumed == St->produced && !St->ended)
+    pthread_cond_wait(&St->filled, &St->lock);
+  St->waitTime += wallTime() - start;
+  int more = St->consumed < St->produced;
+  if (more) {
+    size_t slot = St->consumed % BLOCKS;
+    *begin = St->blocks[slot];
+    *end = St->blocks[slot] + St->length[slot];
+    St->holding = 1;
+  }
+  // The producer has ended unless there is a block
+  const char *error = more ? NULL : St->error;
+  pthread_mutex_unlock(&St->lock);
+  // Errors are reported once the data before them is consumed
+  if (!more && error) {
+    printf("parse error: %s\n", error);
+    exit(1);
+  }
+  return more;
+}
+
+void closeStream(stream_t *St, double *decompressTime, double *waitTime) {
+  pthread_mutex_lock(&St->lock);
+  St->stop = 1;
+  pthread_cond_signal(&St->freed);
+  pthread_mutex_unlock(&St->lock);
+  pthread_join(St->thread, NULL);
+#ifdef HAVE_ZLIB
+  if (St->format == GZIP)
+    inflateEnd(&St->z);
+#endif
+#ifdef HAVE_LZMA
+  if (St->format == XZ)
+    lzma_end(&St->x);
+#endif
+#ifdef HAVE_BZIP2
+  if (St->format == BZIP2)
+    BZ2_bzDecompressEnd(&St->b);
+#endif
+  pthread_mutex_destroy(&St->lock);
+  pthread_cond_destroy(&St->filled);
+  pthread_cond_destroy(&St->freed);
+  for (int i = 0; i < BLOCKS; i++)
+    free(St->blocks[i]);
+  *decompressTime = St->decompressTime;
+  *waitTime = St->waitTime;
+  free(St);
+}
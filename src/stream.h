@@ -1,4 +1,4 @@
-/**************************************************************[utils.c]*******
+/**************************************************************[stream.h]*****
 
   The MIT License
 
@@ -10,7 +10,7 @@
   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
   copies of the Software, and to permit persons to whom the Software is
   furnished to do so, subject to the following conditions:
-nn
+
   The above copyright notice and this permission notice shall be included in all
   copies or substantial portions of the Software.
 
@@ -24,62 +24,35 @@ nn
 
 *******************************************************************************/
 
-#include <stdio.h>
-#include <stdlib.h>
-
-// Function to swap two numbers
-void swap(char *x, char *y) {
-  char t = *x;
-  *x = *y;
-  *y = t;
-}
-
-// Function to reverse `buffer[i…j]`
-char *reverse(char *buffer, int i, int j) {
-  while (i < j) {
-    swap(&buffer[i++], &buffer[j--]);
-  }
-
-  return buffer;
-}
-
-// Iterative function to implement `itoa()` function in C
-char *itoa(int value, char *buffer, int base) {
-  // invalid input
-  if (base < 2 || base > 32) {
-    return buffer;
-  }
-
-  // consider the absolute value of the number
-  int n = abs(value);
-
-  int i = 0;
-  while (n) {
-    int r = n % base;
-
-    if (r >= 10) {
-      buffer[i++] = 65 + (r - 10);
-    } else {
-      buffer[i++] = 48 + r;
-    }
-
-    n = n / base;
-  }
-
-  // if the number is 0
-  if (i == 0) {
-    buffer[i++] = '0';
-  }
-
-  // If the base is 10 and the value is negative, the resulting string
-  // is preceded with a minus sign (-)
-  // With any other base, value is always considered unsigned
-  if (value < 0 && base == 10) {
-    buffer[i++] = '-';
-  }
-
-  buffer[i] = '\0'; // null terminate string
-
-  // reverse the string and return it
-  return reverse(buffer, 0, i - 1);
-}
+/* Input streams for files that cannot be mapped: pipes and gzip, xz or
+ * bzip2 compressed files. A producer thread reads and decompresses the
+ * input into a ring of blocks, which the parser consumes in order.
+ */
+
+#ifndef STREAM
+#define STREAM
+
+#include <stddef.h>
+
+enum { PLAIN = 0, GZIP = 1, XZ = 2, BZIP2 = 3 };
+
+typedef struct stream stream_t;
+
+// Detect the compression format from the first bytes of a file
+int compressionFormat(const unsigned char *magic, size_t size);
+
+// Start a producer thread decoding the file descriptor fd
+stream_t *openStream(int fd);
+
+// Release the current block and wait for the next one
+// Return 0 at the end of the input
+int nextBlock(stream_t *, const char **begin, const char **end);
+
+// Stop the producer and free the stream. Store the time the producer
+// spent reading and decompressing, and the time the consumer waited.
+void closeStream(stream_t *, double *decompressTime, double *waitTime);
+
+// Wall clock in seconds
+double wallTime();
+
+#endif
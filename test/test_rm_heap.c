@@ -18,6 +18,7 @@
  * supports random internal variable modification by their index.
  */
 #include <stdio.h>
+#include <stdlib.h>
 #include "munit.h"
 #include "rm_heap.h"
 
@@ -91,9 +92,170 @@ void test_rm_heap_update() {
   printf("Test rm_heap_update() OK.\n");
 }
 
+// Random pushes, pops and updates checked against a plain array
+void test_rm_heap_random() {
+  enum { N = 1000 };
+  float vals[N];
+  bool in[N] = {false};
+  rm_heap_t H;
+  rm_heap_init_heap(&H, N);
+  srand(1);
+  // Fill the heap to its max size
+  for (int i = 0; i < N; i++) {
+    vals[i] = rand() % 10000 / 100.0f;
+    in[i] = true;
+    rm_heap_push(&H, i, vals[i]);
+  }
+  munit_assert_size(H.size, ==, N);
+  for (int step = 0; step < 100000; step++) {
+    int lit = rand() % N, op = rand() % 4;
+    if (op == 0 && H.size > 0) {
+      // The popped value is the largest one
+      float max = -1;
+      for (int i = 0; i < N; i++)
+        if (in[i] && vals[i] > max)
+          max = vals[i];
+      int idx;
+      munit_assert_float(rm_heap_pop(&H, &idx), ==, max);
+      munit_assert_float(vals[idx], ==, max);
+      munit_assert_true(in[idx]);
+      in[idx] = false;
+    } else if (!in[lit]) {
+      vals[lit] = rand() % 10000 / 100.0f;
+      in[lit] = true;
+      rm_heap_push(&H, lit, vals[lit]);
+    } else {
+      // Increase, decrease or keep the value
+      vals[lit] = rand() % 10000 / 100.0f;
+      rm_heap_update(&H, lit, vals[lit]);
+    }
+    munit_assert_true(rm_heap_in_heap(&H, lit) == in[lit]);
+  }
+  // Pop the rest in order
+  float last = 1e9;
+  int idx;
+  while (H.size > 0) {
+    float val = rm_heap_pop(&H, &idx);
+    munit_assert_float(val, <=, last);
+    munit_assert_float(val, ==, vals[idx]);
+    last = val;
+  }
+  rm_heap_destroy_heap(&H);
+  printf("Test random rm_heap_push(), rm_heap_pop() and rm_heap_update() "
+         "OK.\n");
+}
+
+void test_rm_heap_clear_scale() {
+  rm_heap_t H;
+  rm_heap_init_heap(&H, 100);
+  for (int i = 0; i < 50; i++) {
+    rm_heap_push(&H, 2 * i, i);
+  }
+  // Scaling keeps the order
+  rm_heap_scale(&H, 0.5);
+  int idx;
+  munit_assert_double_equal(rm_heap_peek(&H, &idx), 24.5, 5);
+  munit_assert_int(idx, ==, 98);
+  // The arrays are kept
+  int* indices = H.indices;
+  rm_heap_clear(&H);
+  munit_assert_ptr_equal(H.indices, indices);
+  munit_assert_size(H.size, ==, 0);
+  for (int i = 0; i < 100; i++) {
+    munit_assert_false(rm_heap_in_heap(&H, i));
+  }
+  // The heap can be filled again
+  rm_heap_push(&H, 5, 1.5);
+  rm_heap_push(&H, 7, 2.5);
+  munit_assert_double_equal(rm_heap_pop(&H, &idx), 2.5, 5);
+  munit_assert_int(idx, ==, 7);
+  rm_heap_destroy_heap(&H);
+  printf("Test rm_heap_clear() and rm_heap_scale() OK.\n");
+}
+
+// Pop all values, check that they come in order and match vals
+static void check_pop_all(rm_heap_t* H, const float* vals, size_t n) {
+  float last = 1e9;
+  int idx;
+  munit_assert_size(H->size, ==, n);
+  while (H->size > 0) {
+    float val = rm_heap_pop(H, &idx);
+    munit_assert_float(val, <=, last);
+    munit_assert_float(val, ==, vals[idx]);
+    last = val;
+  }
+}
+
+void test_rm_heap_build() {
+  enum { N = 1000 };
+  float vals[N];
+  int lits[N];
+  rm_heap_t H;
+  rm_heap_init_heap(&H, N);
+  srand(2);
+  for (int i = 0; i < N; i++) {
+    vals[i] = rand() % 10000 / 100.0f;
+  }
+  // Every heap size up to the max size
+  for (int n = 0; n <= N; n += n < 20 ? 1 : 97) {
+    // The odd literals first, then the even ones
+    for (int i = 0; i < n; i++) {
+      lits[i] = i < N / 2 ? 2 * i + 1 : 2 * (i - N / 2);
+    }
+    rm_heap_push(&H, 0, 100);
+    rm_heap_build(&H, lits, n, vals);
+    for (int i = 0; i < N; i++) {
+      bool in = false;
+      for (int j = 0; j < n; j++)
+        in |= lits[j] == i;
+      munit_assert_true(rm_heap_in_heap(&H, i) == in);
+    }
+    check_pop_all(&H, vals, n);
+  }
+  rm_heap_destroy_heap(&H);
+  printf("Test rm_heap_build() OK.\n");
+}
+
+void test_rm_heap_batch() {
+  enum { N = 1000 };
+  float vals[N];
+  int lits[N];
+  rm_heap_t H;
+  rm_heap_init_heap(&H, N);
+  srand(3);
+  // Few updates are applied one by one, many by a rebuild
+  int counts[4] = {1, 10, 500, 3 * N};
+  for (int c = 0; c < 4; c++) {
+    for (int i = 0; i < N; i++) {
+      vals[i] = rand() % 10000 / 100.0f;
+      lits[i] = i;
+    }
+    // All literals but the last are in heap
+    rm_heap_build(&H, lits, N - 1, vals);
+    for (int i = 0; i < counts[c]; i++) {
+      int lit = rand() % N;
+      vals[lit] = rand() % 10000 / 100.0f;
+      rm_heap_batch_set(&H, lit, vals[lit]);
+    }
+    rm_heap_batch_end(&H);
+    munit_assert_false(rm_heap_in_heap(&H, N - 1));
+    check_pop_all(&H, vals, N - 1);
+  }
+  rm_heap_destroy_heap(&H);
+  printf("Test rm_heap_batch_set() and rm_heap_batch_end() OK.\n");
+}
+
 int main() {
-  printf("Initializing test.\n");
+#ifdef DARY_HEAP
+  printf("Initializing test of the %d-ary heap.\n", RM_HEAP_ARITY);
+#else
+  printf("Initializing test of the binary heap.\n");
+#endif
   test_rm_heap_in_heap();
   test_rm_heap_push_pop();
   test_rm_heap_update();
+  test_rm_heap_random();
+  test_rm_heap_clear_scale();
+  test_rm_heap_build();
+  test_rm_heap_batch();
 }